@@ -0,0 +1,357 @@
+// bench.cpp
+
+#include "world.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+//Headless benchmarks of the simulation's hot paths. Every scenario builds its world from a fixed seed, so two builds run exactly the same ticks and the
+//checksum column shows when a change altered what is simulated rather than how fast. Results go to a CSV, one row per scenario, e.g.
+//"playground_bench --out bench.csv --threads 0 --only astar"
+
+//Every allocation of the process is counted, the scheduler's workers included
+namespace bench {
+	std::atomic<uint64_t> allocations {0};
+	std::atomic<uint64_t> allocatedBytes {0};
+
+	void* Allocate (size_t size)
+	{
+		allocations.fetch_add (1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add (size, std::memory_order_relaxed);
+		return std::malloc (size ? size : 1);
+	}
+
+	void* AllocateAligned (size_t size, std::align_val_t alignment)
+	{
+		allocations.fetch_add (1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add (size, std::memory_order_relaxed);
+#ifdef _MSC_VER
+		return _aligned_malloc (size ? size : 1, (size_t)alignment);
+#else
+		return std::aligned_alloc ((size_t)alignment, ((size ? size : 1) + (size_t)alignment - 1) / (size_t)alignment * (size_t)alignment);
+#endif
+	}
+
+	void FreeAligned (void* pointer)
+	{
+#ifdef _MSC_VER
+		_aligned_free (pointer);
+#else
+		std::free (pointer);
+#endif
+	}
+}
+
+void* operator new (size_t size)
+{
+	if (void* pointer = bench::Allocate (size))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc ();
+}
+
+void* operator new[] (size_t size)
+{
+	return operator new (size);
+}
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+	return bench::Allocate (size);
+}
+
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept
+{
+	return bench::Allocate (size);
+}
+
+void* operator new (size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = bench::AllocateAligned (size, alignment))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc ();
+}
+
+void* operator new[] (size_t size, std::align_val_t alignment)
+{
+	return operator new (size, alignment);
+}
+
+void operator delete	(void* pointer) noexcept								{ std::free (pointer); }
+void operator delete[]	(void* pointer) noexcept								{ std::free (pointer); }
+void operator delete	(void* pointer, size_t) noexcept						{ std::free (pointer); }
+void operator delete[]	(void* pointer, size_t) noexcept						{ std::free (pointer); }
+void operator delete	(void* pointer, const std::nothrow_t&) noexcept			{ std::free (pointer); }
+void operator delete[]	(void* pointer, const std::nothrow_t&) noexcept			{ std::free (pointer); }
+void operator delete	(void* pointer, std::align_val_t) noexcept				{ bench::FreeAligned (pointer); }
+void operator delete[]	(void* pointer, std::align_val_t) noexcept				{ bench::FreeAligned (pointer); }
+void operator delete	(void* pointer, size_t, std::align_val_t) noexcept		{ bench::FreeAligned (pointer); }
+void operator delete[]	(void* pointer, size_t, std::align_val_t) noexcept		{ bench::FreeAligned (pointer); }
+
+namespace bench {
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr uint64_t SEED			  = 5806;
+	static constexpr int	  SEARCHES_PER_TICK = 64; //A* scenarios have no agents, a tick is this many searches between random tiles instead
+
+	struct Scenario {
+		enum Work {
+			Simulate, //World::update, the agents are the living sheep, wolves and herders
+			GrowGrass, //World::update without agents, the agents are the tiles
+			SearchPaths,
+		};
+
+		const char* name		 = nullptr;
+		Work		work		 = Simulate;
+		int			columns		 = 0;
+		int			rows		 = 0;
+		int			sheep		 = 0;
+		int			wolves		 = 0;
+		int			herders		 = 0;
+		int			warmupTicks	 = 0; //Run before measuring, so spawning and first-time allocations are left out
+		int			ticks		 = 0;
+		bool		maze		 = false; //Walls painted the way the editor does, with one gap per wall
+		bool		manure		 = false; //Every third tile starts with manure and sheep defecate often
+	};
+
+	static const Scenario SCENARIOS[] = {
+		{"astar_open_64",		Scenario::SearchPaths,	64,	  64,	0,	   0,  0, 2,	50},
+		{"astar_open_128",		Scenario::SearchPaths,	128,  128,	0,	   0,  0, 2,	50},
+		{"astar_open_256",		Scenario::SearchPaths,	256,  256,	0,	   0,  0, 2,	25},
+		{"astar_open_512",		Scenario::SearchPaths,	512,  512,	0,	   0,  0, 2,	10},
+		{"astar_maze_64",		Scenario::SearchPaths,	64,	  64,	0,	   0,  0, 2,	25,	 true},
+		{"astar_maze_128",		Scenario::SearchPaths,	128,  128,	0,	   0,  0, 2,	10,	 true},
+		{"grass_1m",			Scenario::GrowGrass,	1000, 1000, 0,	   0,  0, 30,	150},
+		{"flock_hunt_10k",		Scenario::Simulate,		400,  300,	10000, 40, 1, 30,	90},
+		{"manure_pasture",		Scenario::Simulate,		200,  200,	2000,  0,  1, 30,	300, false, true},
+	};
+
+	struct Result {
+		double	 seconds		= 0.0;
+		uint64_t ticks			= 0;
+		uint64_t agentTicks		= 0;
+		uint64_t allocations	= 0;
+		uint64_t allocatedBytes = 0;
+		uint64_t checksum		= 0;
+	};
+
+	static sim::WorldConfig MakeConfig (const Scenario& scenario)
+	{
+		sim::WorldConfig config;
+		config.worldColumns = scenario.columns;
+		config.worldRows = scenario.rows;
+		config.startAmountSheep = scenario.sheep;
+		config.startAmountWolves = scenario.wolves;
+		config.startAmountHerders = scenario.herders;
+		if (scenario.manure)
+		{
+			config.sheepDelayDefecating = 0.5f;
+			config.manureMaxDuration = 60.0f;
+		}
+		return config;
+	}
+
+	//Vertical walls every fourth column, the gap alternating between the bottom and the top row, so a path has to snake through all of them
+	static void PaintMaze (sim::World& world)
+	{
+		for (int x = 2; x < world.m_world_size.x; x += 4)
+		{
+			const int gap = (x / 4) % 2 == 0 ? world.m_world_size.y - 1 : 0;
+			for (int y = 0; y < world.m_world_size.y; y++)
+			{
+				if (y != gap)
+				{
+					world.set_tile_active ({x, y}, false);
+				}
+			}
+		}
+	}
+
+	static void SpreadManure (sim::World& world)
+	{
+		for (int index = 0; index < (int)world.allManure.size (); index += 3)
+		{
+			world.allManure[index].SpawnManure ();
+		}
+	}
+
+	static int CountAgents (const sim::World& world)
+	{
+		int agents = (int)world.m_wolves.size () + (int)world.m_herders.size ();
+		for (const sim::Sheep& sheep : world.m_sheep)
+		{
+			agents += sheep.isAlive ? 1 : 0;
+		}
+		return agents;
+	}
+
+	static sim::Point RandomWalkableTile (const sim::World& world, sim::Random& random)
+	{
+		for (;;)
+		{
+			const sim::Point tile = {random.Range (0, world.m_world_size.x - 1), random.Range (0, world.m_world_size.y - 1)};
+			if (world.is_walkable (tile))
+			{
+				return tile;
+			}
+		}
+	}
+
+	static void SearchPaths (sim::World& world, sim::Random& random, std::vector<sim::Point>& path, uint64_t& checksum)
+	{
+		for (int i = 0; i < SEARCHES_PER_TICK; i++)
+		{
+			const sim::Point start = RandomWalkableTile (world, random);
+			const sim::Point target = RandomWalkableTile (world, random);
+			const sim::PathStats stats = world.AStarPathFinding (start, target, path, {sim::PathAgent::SheepAgent, i});
+			checksum = sim::Random::Mix (checksum ^ (uint64_t)stats.expanded ^ ((uint64_t)stats.pathLength << 32));
+		}
+	}
+
+	static Result Run (const Scenario& scenario, sim::Scheduler* scheduler)
+	{
+		std::unique_ptr<sim::World> world = std::make_unique<sim::World> ();
+		world->init (scenario.columns * sim::World::TILE_SIZE, scenario.rows * sim::World::TILE_SIZE, nullptr, nullptr, SEED, scheduler, MakeConfig (scenario));
+		if (scenario.maze)
+		{
+			PaintMaze (*world);
+		}
+		if (scenario.manure)
+		{
+			SpreadManure (*world);
+		}
+
+		Result result;
+		sim::Random random (SEED, sim::Random::WorldSpawn, 0);
+		std::vector<sim::Point> path;
+		uint64_t pathChecksum = 0;
+
+		auto tick = [&] {
+			if (scenario.work == Scenario::SearchPaths)
+			{
+				SearchPaths (*world, random, path, pathChecksum);
+			}
+			else
+			{
+				world->update (sim::World::TICK_SECONDS);
+			}
+		};
+
+		for (int i = 0; i < scenario.warmupTicks; i++)
+		{
+			tick ();
+		}
+
+		//Only the ticks themselves are timed and counted, not counting the agents between them
+		for (int i = 0; i < scenario.ticks; i++)
+		{
+			result.agentTicks += scenario.work == Scenario::SearchPaths ? (uint64_t)SEARCHES_PER_TICK
+							   : scenario.work == Scenario::GrowGrass	? (uint64_t)world->m_grass.size ()
+																		: (uint64_t)CountAgents (*world);
+
+			const uint64_t allocationsBefore = allocations.load (std::memory_order_relaxed);
+			const uint64_t bytesBefore = allocatedBytes.load (std::memory_order_relaxed);
+			const Clock::time_point start = Clock::now ();
+			tick ();
+			result.seconds += std::chrono::duration<double> (Clock::now () - start).count ();
+			result.allocations += allocations.load (std::memory_order_relaxed) - allocationsBefore;
+			result.allocatedBytes += allocatedBytes.load (std::memory_order_relaxed) - bytesBefore;
+		}
+
+		result.ticks = scenario.ticks;
+		result.checksum = scenario.work == Scenario::SearchPaths ? pathChecksum : world->Checksum ();
+		world->shut ();
+		return result;
+	}
+}
+
+//Returns the value following "name" on the command line, or nullptr
+static const char* FindArgument (int argc, char** argv, std::string_view name)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string_view (argv[i]) == name)
+		{
+			return argv[i + 1];
+		}
+	}
+	return nullptr;
+}
+
+int main (int argc, char** argv)
+{
+	//"--out <file>" for the CSV, "--threads <n>" scheduler workers besides the main thread, "--only <text>" runs the scenarios whose name contains it
+	const char* out_path = FindArgument (argc, argv, "--out");
+	const char* threads = FindArgument (argc, argv, "--threads");
+	const char* only = FindArgument (argc, argv, "--only");
+
+	const std::string path = out_path ? out_path : "bench.csv";
+	std::ofstream file (path);
+	if (!file)
+	{
+		std::fprintf (stderr, "BENCH: Could not write '%s'\n", path.c_str ());
+		return 1;
+	}
+
+	SetTraceLogLevel (LOG_WARNING);
+
+	const int cores = (int)std::thread::hardware_concurrency ();
+	const int workers = threads ? std::atoi (threads) : cores > 1 ? cores - 1 : 0;
+	sim::Scheduler scheduler;
+	scheduler.Start (workers);
+
+	file << "scenario,seed,columns,rows,threads,ticks,seconds,ticks_per_second,agent_ticks,ns_per_agent_tick,allocations,allocated_bytes,allocations_per_tick,checksum\n";
+	std::printf ("%-18s %12s %18s %14s %16s\n", "scenario", "ticks/s", "ns/agent-tick", "allocs/tick", "checksum");
+
+	for (const bench::Scenario& scenario : bench::SCENARIOS)
+	{
+		if (only && std::string_view (scenario.name).find (only) == std::string_view::npos)
+		{
+			continue;
+		}
+
+		const bench::Result result = bench::Run (scenario, &scheduler);
+		const double ticks_per_second = result.seconds > 0.0 ? (double)result.ticks / result.seconds : 0.0;
+		const double ns_per_agent_tick = result.agentTicks > 0 ? result.seconds * 1e9 / (double)result.agentTicks : 0.0;
+		const double allocations_per_tick = (double)result.allocations / (double)result.ticks;
+
+		char checksum[17];
+		std::snprintf (checksum, sizeof (checksum), "%016llx", (unsigned long long)result.checksum);
+
+		file << scenario.name
+			 << ',' << bench::SEED
+			 << ',' << scenario.columns
+			 << ',' << scenario.rows
+			 << ',' << workers + 1
+			 << ',' << result.ticks
+			 << ',' << result.seconds
+			 << ',' << ticks_per_second
+			 << ',' << result.agentTicks
+			 << ',' << ns_per_agent_tick
+			 << ',' << result.allocations
+			 << ',' << result.allocatedBytes
+			 << ',' << allocations_per_tick
+			 << ',' << checksum << '\n';
+		file.flush ();
+
+		std::printf ("%-18s %12.1f %18.1f %14.1f %16s\n", scenario.name, ticks_per_second, ns_per_agent_tick, allocations_per_tick, checksum);
+	}
+
+	scheduler.Stop ();
+	return 0;
+}
@@ -0,0 +1,31 @@
+//CommandBuffer.h
+
+#pragma once
+
+#include "common.hpp"
+
+namespace sim {
+	//Structural and cross-entity changes of one tick. They are queued while the agents update and played back by the world at the end of the tick, so nothing changes m_sheep (or another agent) while it is being iterated.
+	struct CommandBuffer {
+		struct Command {
+			enum Type {
+				SpawnSheep,
+				KillSheep,
+				PairSheep,
+				UnpairSheep,
+				EatSheep,
+				AttackHerder,
+			};
+
+			Type	type	 = SpawnSheep;
+			int		target	 = -1;
+			Vector2 position{};
+		};
+
+		void Push	(Command::Type type, int target = -1, const Vector2& position = {});
+		void Clear	();
+		int  Count	(Command::Type type) const;
+
+		std::vector<Command> commands;
+	};
+}
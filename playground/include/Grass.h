@@ -18,9 +18,6 @@ namespace sim {
 			Wilting,
 		};
 
-		static constexpr float NORMAL_GROW_SPEED		= 0.01f;
-		static constexpr float FERTILISED_GROW_SPEED	= 0.05f;
-
 		static constexpr Rectangle sources[6] =
 		{
 		   { 16.0f, 0.0f, 16.0f, 16.0f }, // Seed
@@ -41,7 +38,7 @@ namespace sim {
 
 		void	SpawnGrass ();
 		void	DespawnGrass ();
-		void	Update (float dt);
+		void	Update (float dt, std::vector<Point>& spreadRequests);
 
 		State currentState = Growing;
 		Point m_tile_coord;
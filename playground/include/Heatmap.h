@@ -0,0 +1,39 @@
+//Heatmap.h
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace sim {
+	//How often something happened on every tile, for tuning. The simulation records events as they happen and every layer keeps the tiles that changed since they were last taken,
+	//so whoever draws the layer only has to update those. Recording locks the layer once per call, path searches record from parallel jobs.
+	struct Heatmap {
+		enum Layer {
+			SheepPresence,	//A living sheep stood on the tile, every tick
+			GrassEaten,
+			WolfKills,		//A wolf's bite killed a sheep there
+			PathExpansions, //A* expanded the tile
+			LAYER_COUNT,
+		};
+
+		static constexpr const char* LAYER_NAMES[LAYER_COUNT] = {"Sheep presence", "Grass eaten", "Wolf kills", "A* expansions"};
+
+		struct Counts {
+			std::mutex			  mutex;
+			std::vector<uint32_t> counts;
+			std::vector<int>	  dirty;
+			std::vector<uint8_t>  dirtyFlags;
+			uint32_t			  maxCount = 0;
+		};
+
+		void	 Init		(int tileCount);
+		void	 Record		(Layer layer, int index);
+		void	 Record		(Layer layer, const std::vector<int>& indices);
+		void	 TakeDirty	(Layer layer, std::vector<int>& indices); //Swaps the tiles changed since the last call into indices
+		uint32_t Scale		(Layer layer); //The smallest power of two the highest count fits in, so the colours only have to be redone when it doubles
+
+		Counts layers[LAYER_COUNT];
+	};
+}
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "common.hpp"
+#include "SpriteBatch.h"
+#include "PathStats.h"
 
 namespace sim {
 	struct World;
@@ -11,6 +13,7 @@ namespace sim {
 		Herder () = default;
 
 		static constexpr float WALKING_SPEED = 70.f;
+		static constexpr float RADIUS = 25.f;
 		static constexpr float STUN_TIME_ATTACKED = 4.f;
 		static constexpr Rectangle NORMAL_SOURCE = {112.f, 56.f, 48.f, 41.f};
 		static constexpr Rectangle TARGET_FRAME_SOURCE = {32.f, 16.f, 16.f, 16.f};
@@ -26,9 +29,9 @@ namespace sim {
 		void set_sprite_origin (const Vector2& origin);
 		void set_sprite_source (const Rectangle& source);
 
-		void Init	();
+		void Init	(const Point& tile);
 		void Update (float dt);
-		void Render (const Texture& texture) const;
+		void Render (SpriteBatch& batch) const;
 
 		std::vector<Point>path;
 
@@ -48,6 +51,10 @@ namespace sim {
 		bool      m_flip_x{};
 		bool	  isAttacked = false;
 
+		int		  id = -1; //Index in the world's herders
+
+		AgentPathStats pathStats; //Of its A* searches, shown in edit mode
+
 		World* world = nullptr;
 	};
 }
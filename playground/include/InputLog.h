@@ -0,0 +1,61 @@
+//InputLog.h
+
+#pragma once
+
+#include "common.hpp"
+#include "WorldConfig.h"
+#include <string>
+
+namespace sim {
+	struct World;
+	struct Scheduler;
+
+	//Everything from outside the simulation that changed a world, keyed by the tick it was applied before, plus a checksum of the world after every tick.
+	//Replaying the events on a world created from the same seed, map and config has to give the same checksums.
+	struct InputLog {
+		static constexpr uint32_t MAGIC	  = 0x54504E49; //"INPT"
+		static constexpr uint32_t VERSION = 3; //2: herder selection, the WorldConfig grew. 3: world size in the WorldConfig
+
+		struct Event {
+			enum Type : uint32_t {
+				HerderTarget, //x, y: world position clicked
+				TileActive,	  //x, y: tile coord
+				TileInactive, //x, y: tile coord
+				ModeSwitch,	  //x: mode switched to, only informational (edits are applied on their tick anyway)
+				View,		  //x, y, width, height: camera view, it decides the level of detail
+				SelectHerder, //x: herder the player's clicks move from now on
+			};
+
+			uint64_t tick  = 0;
+			Type	 type  = HerderTarget;
+			float	 x	   = 0.f;
+			float	 y	   = 0.f;
+			float	 width = 0.f;
+			float	 height = 0.f;
+		};
+
+		void Begin	(int worldWidth, int worldHeight, uint64_t worldSeed, const WorldConfig& worldConfig, const char* worldMapPath);
+		void Record (const Event& event);
+		void RecordChecksum (uint64_t tick, uint64_t checksum);
+
+		static void Apply (const Event& event, World& world);
+		void ApplyDue	  (World& world, size_t& cursor) const; //Applies the events of the world's current tick, starting at cursor
+
+		bool Verify (uint64_t tick, uint64_t checksum) const; //True if the tick was not recorded or matches
+		bool IsFinished (uint64_t tick, size_t cursor) const; //No events or checksums left from the tick on
+
+		bool SaveFile (const char* path) const;
+		bool LoadFile (const char* path);
+
+		static bool ReplayHeadless (const char* path, Scheduler* scheduler, const char* pathStatsPath = nullptr); //Re-runs every tick without a window, as fast as possible
+
+		int			width	= 0; //Window size the world was created for, it decides the world size without a map
+		int			height	= 0;
+		uint64_t	seed	= 0;
+		WorldConfig config;
+		std::string mapPath;
+
+		std::vector<Event>	  events;
+		std::vector<uint64_t> checksums; //Of the world after each tick, the index is the tick the update started at
+	};
+}
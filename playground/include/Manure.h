@@ -3,6 +3,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "SpriteBatch.h"
 
 namespace sim {
 	struct World;
@@ -11,7 +12,13 @@ namespace sim {
 		Manure () = default;
 
 		static constexpr Rectangle SOURCE	= {16.0f, 16.0f, 16.0f, 16.0f};
-		static constexpr float MAX_DURATION = 10.f;
+
+		//(De)fertilising a neighbouring tile, applied by the world after the (parallel) manure pass
+		struct FertiliseRequest {
+			Point coord;
+			Point nearbyTile;
+			bool  fertilise = true;
+		};
 
 
 		void set_position (const Vector2& position);
@@ -24,8 +31,8 @@ namespace sim {
 		void DespawnManure	();
 
 		void Initiate	(Point& coord);
-		void update		(float dt);
-		void render		(const Texture& texture) const;
+		void update		(float dt, std::vector<FertiliseRequest>& fertiliseRequests);
+		void render		(SpriteBatch& batch) const;
 
 		Vector2   m_position{};
 		Vector2   origin{};
@@ -0,0 +1,49 @@
+//MapFile.h
+
+#pragma once
+
+#include "MappedFile.h"
+
+namespace sim {
+	struct World;
+
+	//Pre-authored terrain, memory mapped so even very large maps open without being read or parsed up front.
+	//Layout: Header, walkability bitset, then the optional layers, every block starting at an 8 byte aligned offset.
+	struct MapFile {
+		static constexpr uint32_t MAGIC	  = 0x3150414D; //"MAP1"
+		static constexpr uint32_t VERSION = 1;
+
+		enum Layer : uint32_t {
+			GrassLayer		= 1 << 0, //One byte per tile, 0 is no grass, 1-255 the age
+			FertilityLayer	= 1 << 1, //Bitset
+		};
+
+		struct Header {
+			uint32_t magic	 = MAGIC;
+			uint32_t version = VERSION;
+			int32_t	 columns = 0;
+			int32_t	 rows	 = 0;
+			uint32_t layers	 = 0;
+			uint32_t reserved = 0;
+			uint64_t walkabilityOffset	= 0;
+			uint64_t grassOffset		= 0;
+			uint64_t fertilityOffset	= 0;
+		};
+
+		bool Open  (const char* path); //Returns false if the file is missing or not a valid map
+		void Close ();
+
+		int	 Columns	() const { return header->columns; }
+		int	 Rows		() const { return header->rows; }
+		bool HasLayer	(Layer layer) const { return (header->layers & layer) != 0; }
+
+		bool  IsWalkable	(int index) const;
+		bool  IsFertilised	(int index) const;
+		float GrassAge		(int index) const;
+
+		static bool Export (const World& world, const char* path);
+
+		MappedFile file;
+		const Header* header = nullptr;
+	};
+}
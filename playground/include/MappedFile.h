@@ -0,0 +1,30 @@
+//MappedFile.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sim {
+	//Read-only memory mapping of a whole file, the OS pages it in on first access.
+	//note: MappedFile.cpp includes the platform headers (windows.h clashes with raylib), so this header and its TU must stay free of raylib
+	struct MappedFile {
+		MappedFile () = default;
+		~MappedFile ();
+
+		MappedFile (const MappedFile&) = delete;
+		MappedFile& operator= (const MappedFile&) = delete;
+
+		bool Open  (const char* path);
+		void Close ();
+
+		bool IsOpen () const { return data != nullptr; }
+
+		const uint8_t* data = nullptr;
+		size_t		   size = 0;
+
+		void*	 fileHandle	   = nullptr; //Windows only
+		void*	 mappingHandle = nullptr; //Windows only
+		intptr_t descriptor	   = -1;	  //POSIX only
+	};
+}
@@ -0,0 +1,81 @@
+//PathStats.h
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+namespace sim {
+	//Who searched a path
+	struct PathAgent {
+		enum Kind {
+			SheepAgent,
+			WolfAgent,
+			HerderAgent,
+			KIND_COUNT,
+		};
+
+		Kind kind  = SheepAgent;
+		int	 id	   = -1;
+		int	 state = 0; //The agent's State when it searched, herders have none
+	};
+
+	//What one A* search cost
+	struct PathStats {
+		int	   expanded		  = 0;
+		int	   frontierPushes = 0;
+		int	   stalePops	  = 0; //Tiles popped again after a cheaper route to them was already expanded
+		int	   pathLength	  = 0;
+		double microseconds	  = 0.0;
+		bool   found		  = false;
+	};
+
+	//Kept by every agent for its debug text
+	struct AgentPathStats {
+		void Add (const PathStats& search);
+
+		int	  searches			= 0;
+		int	  failures			= 0;
+		float lastMicroseconds	= 0.f;
+		int	  lastExpanded		= 0;
+	};
+
+	//The searches of a world summed per agent kind and the state the agent was in, with a latency histogram each. Searches come from parallel jobs, so every call locks
+	struct PathTelemetry {
+		static constexpr int MAX_STATES		   = 4;
+		static constexpr int LATENCY_BUCKETS   = 64; //Quarter octaves of microseconds, the last one takes everything slower
+		static constexpr int BUCKETS_PER_OCTAVE = 4;
+
+		static constexpr const char* KIND_NAMES[PathAgent::KIND_COUNT] = {"Sheep", "Wolf", "Herder"};
+		static constexpr int STATE_COUNTS[PathAgent::KIND_COUNT] = {4, 3, 1};
+		static constexpr const char* STATE_NAMES[PathAgent::KIND_COUNT][MAX_STATES] = {
+			{"Hungry", "Satiated", "Reproducing", "Afraid"}, //Sheep::State
+			{"Hungry", "Satiated", "Asleep"},				 //Wolf::State
+			{"-"},
+		};
+
+		struct Bucket {
+			double Percentile (double fraction) const; //Microseconds, the upper edge of the latency bucket the fraction falls in
+
+			uint64_t searches		= 0;
+			uint64_t failures		= 0;
+			uint64_t expanded		= 0;
+			uint64_t frontierPushes = 0;
+			uint64_t stalePops		= 0;
+			uint64_t pathLength		= 0; //Of the searches that found one
+			double	 microseconds	= 0.0;
+			uint32_t latency[LATENCY_BUCKETS]{};
+		};
+
+		using Table = Bucket[PathAgent::KIND_COUNT][MAX_STATES];
+
+		void Record (const PathAgent& agent, const PathStats& search);
+		void Merge	(const PathTelemetry& other);
+		void Copy	(Table& table) const;
+		void Clear	();
+		bool WriteCsv (const char* path) const;
+
+		mutable std::mutex mutex;
+		Table			   buckets;
+	};
+}
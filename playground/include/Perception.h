@@ -0,0 +1,55 @@
+//Perception.h
+
+#pragma once
+
+#include "common.hpp"
+#include "SpatialGrid.h"
+#include "WakeQueue.h"
+
+namespace sim {
+	struct World;
+
+	//Computes who is near whom once per tick and hands the changes (enter/leave) to the agents that care, so they don't have to poll distances themselves
+	struct Perception {
+		static constexpr float CELL_SIZE = 128.f;
+
+		struct Event {
+			enum Type {
+				SheepEnteredHuntingRange,
+				SheepLeftHuntingRange,
+				HerderEnteredNearby,
+				HerderLeftNearby,
+				HerderEnteredTooClose,
+				HerderLeftTooClose,
+				GrassReached,
+			};
+
+			Type				 type	  = SheepEnteredHuntingRange;
+			WakeQueue::AgentType receiver = WakeQueue::WolfAgent;
+			int					 receiverIndex = 0;
+			int					 subject  = -1; //The sheep the event is about, -1 if none
+			int					 source	  = -1; //The wolf or herder the event is about, -1 if none
+		};
+
+		void Reset	 ();
+		void Update	 (World& world);
+		void Deliver (World& world) const;
+
+		void AddEvent (Event::Type type, WakeQueue::AgentType receiver, int receiverIndex, int subject = -1, int source = -1);
+
+		//Positions of this tick, herders at their centre (position + origin)
+		SpatialGrid m_sheep_grid;
+		SpatialGrid m_wolf_grid;
+		SpatialGrid m_herder_grid;
+
+		std::vector<Event> m_events;
+
+		//State of the previous tick per wolf, to turn the proximity of this tick into enter/leave events
+		std::vector<std::vector<int>> m_sheep_in_hunting_range; //Sorted
+		std::vector<int>			  m_query_result;
+		std::vector<Point>			  m_sheep_tiles;
+
+		std::vector<uint8_t> m_herder_nearby;
+		std::vector<int>	 m_herder_too_close; //Closest herder that is too close, -1 if none
+	};
+}
@@ -0,0 +1,121 @@
+//Profiler.h
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "Trace.h"
+
+//Scoped timers are compiled in unless the build defines SIM_PROFILER=0, then PROFILE_SCOPE expands to nothing
+#ifndef SIM_PROFILER
+#define SIM_PROFILER 1
+#endif
+
+namespace sim {
+	//Frame profiler: RAII scopes add their time to a zone, and every frame the zones of one root are moved into a rolling history.
+	//The hierarchy is fixed by each zone's parent rather than by which scopes are open, a zone timed on a worker thread still belongs under the pass that started it.
+	//Times are summed over all threads, so the parallel passes can add up to more than their parent took.
+	namespace profiler {
+		enum Zone {
+			//Main thread, one frame per rendered frame
+			Frame,
+			FrameUpdate,
+			ApplySnapshot,
+			PrepareRender,
+			FrameRender,
+			RenderGround,
+			RenderSprites,
+			RenderEditor,
+			RenderHud,
+
+			//Simulation thread, one frame per step
+			Step,
+			Tick,
+			GrassPass, //In the order of World::Pass
+			PerceptionPass,
+			SheepPass,
+			ManurePass,
+			HerderPass,
+			WolfPass,
+			CommandPass,
+			PathFinding, //Already included in the pass that searched
+			Publish,
+
+			ZONE_COUNT,
+		};
+
+		static constexpr int NO_PARENT		= -1;
+		static constexpr int HISTORY_FRAMES = 120;
+
+		struct ZoneInfo {
+			const char* name;
+			int			parent;
+			bool		inBar;	//Stacked in the frame bar, the zones of one root that do not overlap
+			bool		traced; //Written to a running trace, unless the code writes a more detailed event of its own
+		};
+
+		static constexpr ZoneInfo ZONES[ZONE_COUNT] = {
+			{"Frame", NO_PARENT, false, true},
+			{"Update", Frame, false, true},
+			{"Apply snapshot", FrameUpdate, true, true},
+			{"Prepare render", FrameUpdate, true, true},
+			{"Render", Frame, false, true},
+			{"Ground", FrameRender, true, true},
+			{"Sprites", FrameRender, true, true},
+			{"Editor overlay", FrameRender, true, true},
+			{"Hud", FrameRender, true, true},
+			{"Step", NO_PARENT, false, true},
+			{"Tick", Step, false, true},
+			{"Grass", Tick, true, true},
+			{"Perception/wake", Tick, true, true},
+			{"Sheep", Tick, true, true},
+			{"Manure", Tick, true, true},
+			{"Herder", Tick, true, true},
+			{"Wolf", Tick, true, true},
+			{"Commands", Tick, true, true},
+			{"A*", Tick, false, false},
+			{"Publish", Step, true, true},
+		};
+
+		//Milliseconds a zone took per frame over the last HISTORY_FRAMES frames of its root
+		struct ZoneStats {
+			double last = 0.0;
+			double min	= 0.0;
+			double avg	= 0.0;
+			double p99	= 0.0;
+		};
+
+		extern std::atomic<int64_t> zoneNanoseconds[ZONE_COUNT]; //Of the frame in progress
+
+		struct Scope {
+			explicit Scope (Zone zone) : zone (zone), start (std::chrono::steady_clock::now ()) {}
+			~Scope ()
+			{
+				const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+				zoneNanoseconds[zone].fetch_add (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count (), std::memory_order_relaxed);
+				if (trace::IsEnabled () && ZONES[zone].traced)
+				{
+					trace::Complete (ZONES[zone].name, "zone", start, end);
+				}
+			}
+
+			Zone								  zone;
+			std::chrono::steady_clock::time_point start;
+		};
+
+		Zone RootOf		(Zone zone);
+		int	 DepthOf	(Zone zone);
+		void EndFrame	(Zone root); //Moves the time of every zone under root into its history, once the frame's scopes are all closed
+		void TakeStats	(ZoneStats (&stats)[ZONE_COUNT]);
+	}
+}
+
+#define PROFILE_CONCAT_LINE(name, line) name##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_CONCAT_LINE (profileScope, line)
+
+#if SIM_PROFILER
+#define PROFILE_SCOPE(zone) const ::sim::profiler::Scope PROFILE_SCOPE_NAME (__LINE__) (zone)
+#else
+#define PROFILE_SCOPE(zone) ((void)0)
+#endif
@@ -0,0 +1,34 @@
+//Random.h
+
+#pragma once
+
+#include <cstdint>
+
+namespace sim {
+	//Counter-based random number generator (SplitMix64 mixing of key + counter).
+	//Every stream is keyed by seed, subsystem and entity/tile, so the numbers an entity draws never depend on update order or on which thread updates it.
+	struct Random {
+		enum Stream : uint32_t {
+			WorldInit,
+			WorldSpawn,
+			GrassSpread,
+			ManureSpread,
+			SheepBehaviour,
+			WolfBehaviour,
+			EditorEdit,
+			WolfDen,
+		};
+
+		Random () = default;
+		Random (uint64_t seed, Stream stream, uint64_t entity, uint64_t subKey = 0);
+
+		static uint64_t Mix (uint64_t value);
+
+		uint64_t Next	();
+		int		 Range	(int min, int max); //Inclusive on both ends, same as GetRandomValue
+		float	 Float	(); //[0, 1)
+
+		uint64_t key		= 0;
+		uint64_t counter	= 0;
+	};
+}
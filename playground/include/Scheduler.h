@@ -0,0 +1,96 @@
+//Scheduler.h
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim {
+	//Tasks of one frame and the dependencies between them. A task can only depend on tasks added before it, so the order they were added in is always a valid serial order.
+	struct TaskGraph {
+		struct Task {
+			int job		= -1; //Index into jobs, -1 for tasks that only join other tasks
+			int index	= 0;  //Argument passed to the job
+			int dependencyCount = 0;
+			std::vector<int> dependents;
+		};
+
+		int Add				(std::function<void ()> work, std::initializer_list<int> dependencies = {});
+		int AddParallelFor	(int count, std::function<void (int)> job, std::initializer_list<int> dependencies = {}); //Returns a task that finishes after all indices
+		int AddTask			(int job, int index, std::initializer_list<int> dependencies);
+
+		void Clear			();
+		void Execute		(int task) const;
+		void RunSerial		() const;
+
+		int Size () const { return taskCount; }
+
+		std::vector<std::function<void (int)>> jobs;
+		std::vector<Task> tasks;
+
+		int taskCount = 0;
+	};
+
+	//Work-stealing scheduler: every thread has its own queue, takes its newest task first and steals the oldest task of another queue when it runs dry
+	struct Scheduler {
+		struct WorkerStats {
+			uint64_t tasksRun		= 0;
+			uint64_t steals			= 0;
+			double	 busySeconds	= 0.0;
+			double	 idleSeconds	= 0.0; //Time spent waiting for work while a graph was running
+		};
+
+		struct Worker {
+			std::mutex		 mutex;
+			std::deque<int>	 queue;
+
+			std::atomic<uint64_t> tasksRun{0};
+			std::atomic<uint64_t> steals{0};
+			std::atomic<int64_t>  busyMicroseconds{0};
+		};
+
+		Scheduler () = default;
+		~Scheduler ();
+
+		Scheduler (const Scheduler&) = delete;
+		Scheduler& operator= (const Scheduler&) = delete;
+
+		void Start (int workerThreads);
+		void Stop  ();
+
+		int  WorkerCount () const; //Worker threads plus the thread calling Run (worker 0)
+		void Run		 (const TaskGraph& graph);
+		void ParallelFor (int count, const std::function<void (int)>& job);
+		void EndFrame	 ();
+
+		void WorkerLoop	 (int workerIndex);
+		void Push		 (int workerIndex, int task);
+		bool PopOrSteal	 (int workerIndex, int& task);
+		void Execute	 (int workerIndex, int task);
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::vector<std::thread>			 threads;
+
+		std::vector<WorkerStats> lastFrameStats; //Stats of the last frame that ran any tasks
+
+		std::mutex				sleepMutex;
+		std::condition_variable wake;
+
+		const TaskGraph*				 graph = nullptr;
+		std::unique_ptr<std::atomic<int>[]> pendingDependencies;
+		int								 pendingCapacity = 0;
+
+		std::atomic<int> remainingTasks{0};
+		std::atomic<int> queuedTasks{0};
+
+		double frameRunSeconds = 0.0;
+		bool   stopping = false;
+	};
+}
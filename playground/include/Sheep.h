@@ -3,7 +3,10 @@
 #pragma once
 
 #include "common.hpp"
-#include "Timer.h"
+#include "SpriteBatch.h"
+#include "PathStats.h"
+#include "Random.h"
+#include "Perception.h"
 
 namespace sim {
 	struct World;
@@ -18,18 +21,20 @@ namespace sim {
 			Afraid,
 		};
 
+		//Level of detail, sheep outside the camera view are simulated coarsely
+		enum Detail {
+			FullDetail,
+			CoarseDetail,
+			DETAIL_COUNT,
+		};
+
 		static constexpr float WALKING_SPEED			= 50.0f;
 		static constexpr float RUNNING_SPEED			= 70.0f;
 		static constexpr float MAX_HEALTH				= 10.f;
-		static constexpr float AMOUNT_GRASS_SATIATED	= 3.f;
-		
-		static constexpr float DELAY_DEFECATING			= 3.0f;
-		static constexpr float DELAY_EATING				= 2.0f;
-		static constexpr float TIME_BEFORE_DAMAGE		= 5.0f;
-		static constexpr float HEALTH_REGENERATION		= 2.0f;
-		
-		static constexpr float GRASS_HUNTING_RANGE		= 150.0f;
-		static constexpr float FLEEING_RANGE			= 300.0f;
+		static constexpr float RADIUS					= 20.0f;
+		static constexpr float COARSE_SENSE_SCALE		= 4.0f; //Off-screen sheep sense this many times less often
+
+		//Behaviour tunables (ranges, delays, intervals) are in the WorldConfig
 
 		static constexpr Rectangle NORMAL_SOURCE		= { 7.0f,  59.0f, 39.0f, 29.0f};
 		static constexpr Rectangle EATING_SOURCE		= {53.0f,  59.0f, 43.0f, 29.0f};
@@ -37,6 +42,32 @@ namespace sim {
 		static constexpr Rectangle SATIATED_SOURCE		= {55.0f, 104.0f, 44.0f, 34.0f};
 		static constexpr Rectangle REPRODUCTION_SOURCE	= {	4.0f, 145.0f, 40.0f, 36.0f};
 
+		//Change to the world or to another sheep, decided during the (parallel) update and committed by the world afterwards, in sheep order
+		struct Intent {
+			enum Type {
+				EatGrassAt,
+				DefecateAt,
+				PairWith,
+				Unpair,
+				SpawnLamb,
+				Die,
+			};
+
+			Type	type	 = EatGrassAt;
+			int		sheep	 = -1;
+			Vector2 position{};
+		};
+
+		//Frozen copy of the state other sheep are allowed to read during the parallel update
+		struct View {
+			Vector2 position{};
+			float	radius{};
+			State	state		= Hungry;
+			bool	isAlive		= false;
+			bool	isMatedWith = false;
+			int		sheepToMate = -1;
+		};
+
 
 
 		void set_position		(const Vector2& position);
@@ -44,6 +75,7 @@ namespace sim {
 		void set_radius			(float radius);
 		void SetTargetPosition	(const Vector2& position);
 		void TraverseUsingPath	(std::vector<Point>& pathToTraverse);
+		void FindPath			(const Point& targetTile);
 
 		void set_sprite_flip_x	(bool state);
 		void set_sprite_origin	(const Vector2& origin);
@@ -58,22 +90,30 @@ namespace sim {
 		void TakeDamage			(float amountDamage);
 		void RegenerateHealth	(float amountRegenerate);
 
-		void GoTowardsMate	(Sheep& sheepMate);
+		void GoTowardsMate	(const View& sheepMate);
 		void Reproduce		();
+		void CancelMating	();
 
 		void RunAway ();
 
 		void Initiate	(const Vector2& position);
-		void update		(float dt);
-		void render		(const Texture& texture) const;
+		void update		(float dt); //Only changes this sheep, everything else is emitted as an intent
+		void AddIntent	(Intent::Type type, int sheep = -1, const Vector2& position = {});
+		void OnPerceptionEvent (const Perception::Event& event);
+		void SetDetail	(Detail newDetail);
+		float SenseInterval () const;
+		View GetView	() const;
+		void render		(SpriteBatch& batch) const;
 
 		void Sense	(State& state, float dt);
 		void Think	(State& state, float dt);
 		void Act	(State& state, float dt);
 
-		std::vector<Point> path;
+		std::vector<Point>	path;
+		std::vector<Intent> intents;
 
 		State     currentState = Hungry;
+		Detail	  detail	   = FullDetail;
 
 		Vector2   m_position{};
 		Vector2   targetPosition{};
@@ -98,11 +138,16 @@ namespace sim {
 		bool canReproduce	= false;
 		bool isBeingHunted	= false;
 		bool isMatedWith	= false;
+		bool senseDue		= false; //Set by the world's wake queue
+		bool thinkDue		= false;
 		
 		int	sheepToMate = -1;
+		int id			= -1;
+		int hunter		= -1; //The wolf hunting this sheep, while isBeingHunted
+
+		AgentPathStats pathStats; //Of its A* searches, shown in edit mode
 
-		Timer senseTimer;
-		Timer thinkTimer;
+		Random random;
 
 		World* world = nullptr;
 	};
@@ -0,0 +1,27 @@
+//Snapshot.h
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace sim {
+	struct World;
+
+	//Versioned binary copy of everything a world needs to continue exactly where it was: every tile layer, every agent, the wake queue, the random streams and the tick.
+	//Dense layers are stored as POD arrays, sparse ones (walls, fertilised ground, manure) run-length encoded.
+	struct Snapshot {
+		static constexpr uint32_t MAGIC	  = 0x50414E53; //"SNAP"
+		static constexpr uint32_t VERSION = 3; //2: wolf and herder populations. 3: world size in the WorldConfig
+
+		void Capture (const World& world);
+		bool Restore (World& world) const; //The world has to be initialised with the same size, returns false (and leaves the world alone) if the snapshot doesn't fit
+
+		bool SaveFile (const char* path) const;
+		bool LoadFile (const char* path);
+
+		bool IsEmpty () const { return bytes.empty (); }
+
+		std::vector<uint8_t> bytes;
+	};
+}
@@ -0,0 +1,34 @@
+//SpatialGrid.h
+
+#pragma once
+
+#include "common.hpp"
+
+namespace sim {
+	//Uniform grid over the world bounds, rebuilt once per tick. Entries are sorted by cell (counting sort), so a query only visits the cells overlapping the query circle.
+	struct SpatialGrid {
+		struct Entry {
+			int		index = -1;
+			Vector2 position{};
+		};
+
+		void Begin	(const Rectangle& bounds, float cellSize);
+		void Add	(int index, const Vector2& position);
+		void Finish	();
+
+		void Query	(const Vector2& center, float radius, std::vector<int>& result) const; //Appends the indices within radius, sorted
+		int	 Closest (const Vector2& center, float radius) const; //Index of the closest entry within radius (the lowest index on a tie), -1 if none
+		void QueryRect (const Rectangle& area, std::vector<int>& result) const; //Appends the indices inside the rectangle, sorted
+
+		Point CellOf	(const Vector2& position) const;
+		int	  CellIndex (const Point& cell) const { return cell.y * m_cells.x + cell.x; }
+
+		Rectangle m_bounds{};
+		Point	  m_cells{};
+		float	  m_cell_size = 1.f;
+
+		std::vector<Entry> m_pending;
+		std::vector<Entry> m_entries;	 //Sorted by cell
+		std::vector<int>   m_cell_start; //Index into m_entries per cell, plus one past the end
+	};
+}
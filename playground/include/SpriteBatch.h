@@ -0,0 +1,31 @@
+//SpriteBatch.h
+
+#pragma once
+
+#include "common.hpp"
+
+namespace sim {
+	//Collects the sprites of one texture and streams them into the rlgl vertex buffer in one go, instead of setting up every sprite in its own DrawTexturePro call
+	struct SpriteBatch {
+		//Counted since the last TakeStats, which the app calls once per frame
+		struct Stats {
+			int quads		= 0;
+			int drawCalls	= 0;
+		};
+
+		struct Quad {
+			float left, top, right, bottom;
+			float u0, v0, u1, v1;
+			Color tint;
+		};
+
+		void  Begin		(const Texture2D& texture);
+		void  Add		(Rectangle source, const Rectangle& destination, const Vector2& origin = {}, Color tint = WHITE); //Same as DrawTexturePro without rotation, a negative source size flips the sprite
+		void  End		();
+		Stats TakeStats ();
+
+		Texture2D		  texture{};
+		std::vector<Quad> quads; //Keeps its capacity between frames
+		Stats			  stats;
+	};
+}
@@ -0,0 +1,86 @@
+//StateStream.h
+
+#pragma once
+
+#include "MappedFile.h"
+#include "WorldConfig.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sim {
+	struct World;
+
+	//What a world looked like every tick (tile layers, agent positions and sprites), for watching a run afterwards without simulating it again.
+	//Every tick is a frame of int32 fields, stored as the difference to the previous frame: runs of unchanged fields are skipped, changed ones written as zigzag varints.
+	//Every KEYFRAME_INTERVAL ticks a frame is stored against an empty frame instead, so seeking only has to decode from the keyframe before it.
+	namespace statestream {
+		static constexpr uint32_t MAGIC	  = 0x4D525453; //"STRM"
+		static constexpr uint32_t VERSION = 3; //2: wolf and herder populations. 3: world size in the WorldConfig
+
+		static constexpr int KEYFRAME_INTERVAL = 256;
+
+		struct Header {
+			uint32_t	magic	= MAGIC;
+			uint32_t	version = VERSION;
+			int32_t		width	= 0;
+			int32_t		height	= 0;
+			uint64_t	seed	= 0;
+			WorldConfig config;
+			uint32_t	mapPathLength = 0;
+			uint32_t	reserved	  = 0;
+		};
+
+		struct FrameHeader {
+			uint64_t tick	  = 0;
+			uint32_t size	  = 0; //Bytes of encoded fields following the header
+			uint32_t keyframe = 0;
+		};
+		static_assert (sizeof (FrameHeader) == 16, "Frame headers are written whole, they must not have padding");
+
+		//The Header is written field by field, so padding the compiler adds after the config never ends up in the file
+		static constexpr size_t HEADER_BYTES = 4 + 4 + 4 + 4 + 8 + sizeof (WorldConfig) + 4 + 4;
+		void WriteHeader (std::ofstream& file, const Header& header);
+		void ReadHeader	 (const uint8_t* data, Header& header); //data holds HEADER_BYTES
+
+		void Capture (const World& world, std::vector<int32_t>& fields);
+		void Apply	 (const std::vector<int32_t>& fields, World& world);
+
+		void Encode (const std::vector<int32_t>& fields, const std::vector<int32_t>& previous, std::vector<uint8_t>& bytes);
+		bool Decode (const uint8_t* data, size_t size, std::vector<int32_t>& fields); //fields holds the previous frame and is updated in place
+	}
+
+	//Appends one frame per tick to a file while the world runs
+	struct StateRecorder {
+		bool Open	(const char* path, int width, int height, const World& world, const char* mapPath);
+		void Record (const World& world);
+		void Close	();
+
+		bool IsOpen () const { return file.is_open (); }
+
+		std::ofstream		 file;
+		std::vector<int32_t> previous;
+		std::vector<int32_t> fields;
+		std::vector<uint8_t> bytes;
+		uint64_t			 frameCount = 0;
+		uint64_t			 totalBytes = 0;
+	};
+
+	//Maps a recorded stream and shows any of its frames in a world
+	struct StatePlayer {
+		bool Open (const char* path);
+
+		int		 FrameCount () const { return (int)frameOffsets.size (); }
+		uint64_t TickAt		(int frame) const;
+		bool	 Seek		(int frame, World& world); //Decodes forward from the current frame or the closest keyframe, then applies it to the world
+
+		statestream::Header header;
+		std::string			mapPath;
+
+		MappedFile			 file;
+		std::vector<size_t>	 frameOffsets; //Of each frame header
+		std::vector<int32_t> fields;	   //Of the current frame
+		int					 current = -1;
+	};
+}
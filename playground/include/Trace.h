@@ -0,0 +1,49 @@
+//Trace.h
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+
+namespace sim {
+	//Records events into a ring buffer per thread and writes them as a Chrome/Perfetto trace (JSON, open it in ui.perfetto.dev or chrome://tracing).
+	//While nothing is recording, every event is a single relaxed load that finds tracing off. Names and argument keys have to be string literals, only their pointers are stored.
+	namespace trace {
+		static constexpr int MAX_ARGS	 = 10;
+		static constexpr int RING_EVENTS = 1 << 15; //Per thread, the oldest events are overwritten first
+
+		using Clock = std::chrono::steady_clock;
+
+		struct Arg {
+			const char* key;
+			int64_t		value;
+		};
+
+		extern std::atomic<bool> enabled;
+
+		inline bool IsEnabled () { return enabled.load (std::memory_order_relaxed); }
+
+		bool Start (const char* path); //Starts recording, the events go to path on Flush or Stop
+		void Stop  ();				   //Flushes and stops recording, nothing happens if it wasn't
+		bool Flush ();				   //Writes everything recorded so far, recording goes on
+		const char* Path ();
+
+		void SetThreadName (const char* name);
+
+		//Complete event ("X"), a span on the calling thread's track
+		void Complete (const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::initializer_list<Arg> args = {});
+		//Instant event ("i"), a point in time
+		void Instant  (const char* name, const char* category, std::initializer_list<Arg> args = {});
+
+		//An agent's state changed while it sensed or thought
+		inline void StateChange (const char* name, int id, int from, int to)
+		{
+			if (IsEnabled () && from != to)
+			{
+				Instant (name, "agent", {{"id", id}, {"from", from}, {"to", to}});
+			}
+		}
+	}
+}
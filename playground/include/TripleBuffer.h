@@ -0,0 +1,37 @@
+//TripleBuffer.h
+
+#pragma once
+
+#include <atomic>
+
+namespace sim {
+	//Hands the newest value from one producer thread to one consumer thread without locks. The producer fills the back slot and publishes it, the consumer swaps the newest published slot to the front.
+	//Neither side ever waits for the other, a value published while the consumer is still busy simply replaces the previous one.
+	template <typename T>
+	struct TripleBuffer {
+		static constexpr int INDEX_MASK = 3;
+		static constexpr int FRESH_BIT	= 4; //Set while the middle slot holds a value the consumer has not taken yet
+
+		//Producer side
+		T&	 Back ()	{ return slots[back]; }
+		void Publish () { back = middle.exchange (back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK; }
+
+		//Consumer side, false if nothing new was published since the last call
+		bool Acquire ()
+		{
+			if ((middle.load (std::memory_order_acquire) & FRESH_BIT) == 0)
+			{
+				return false;
+			}
+			front = middle.exchange (front, std::memory_order_acq_rel) & INDEX_MASK;
+			return true;
+		}
+		const T& Front () const { return slots[front]; }
+
+		T slots[3];
+
+		int				 back	= 0;
+		std::atomic<int> middle	{1};
+		int				 front	= 2;
+	};
+}
@@ -0,0 +1,38 @@
+//WakeQueue.h
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace sim {
+	//Bucketed priority queue (timing wheel) of the ticks at which agents sense or think next. A wake-up lives in the bucket of its tick modulo BUCKET_COUNT, so popping a tick only looks at one bucket.
+	struct WakeQueue {
+		static constexpr int BUCKET_COUNT = 64;
+
+		enum AgentType {
+			SheepAgent,
+			WolfAgent,
+		};
+
+		enum Phase {
+			Sense,
+			Think,
+		};
+
+		struct WakeUp {
+			uint64_t  tick	= 0;
+			AgentType agent = SheepAgent;
+			int		  index = 0;
+			Phase	  phase = Sense;
+		};
+
+		void Clear				();
+		void Schedule			(const WakeUp& wakeUp);
+		void ScheduleStaggered	(uint64_t firstTick, int interval, WakeUp wakeUp); //Uses the least loaded tick of [firstTick, firstTick + interval)
+		void PopDue				(uint64_t tick, std::vector<WakeUp>& due);
+		int  Load				(uint64_t tick) const;
+
+		std::vector<WakeUp> buckets[BUCKET_COUNT];
+	};
+}
@@ -3,7 +3,11 @@
 #pragma once
 
 #include "common.hpp"
+#include "SpriteBatch.h"
+#include "PathStats.h"
 #include "Timer.h"
+#include "Random.h"
+#include "Perception.h"
 
 namespace sim {
 	struct World;
@@ -20,12 +24,8 @@ namespace sim {
 
 		static constexpr float WALKING_SPEED			= 50.0f;
 		static constexpr float RUNNING_SPEED			= 75.0f;
-		static constexpr float MAX_HUNTING_DISTANCE		= 200.f;
-		static constexpr float MAX_WANDERING_DISTANCE	= 300.f;
-		static constexpr float SLEEP_TIME				= 10.f;
-		static constexpr float DELAY_BETWEEN_EATING		= 3.f;
 
-		static constexpr int AMOUNT_SHEEP_SATIATED = 3;
+		//Behaviour tunables (ranges, delays, intervals) are in the WorldConfig
 
 		static constexpr Rectangle HUNGRY_SOURCE	= {36.f, 194.f, 33.f, 28.f};
 		static constexpr Rectangle SATIATED_SOURCE	= {10.f, 194.f, 23.f, 28.f};
@@ -44,7 +44,7 @@ namespace sim {
 		void SetTargetPosition (const Vector2& position);
 		void TraverseUsingPath (std::vector<Point>& pathToTraverse);
 
-		void Spawn	 ();
+		void Spawn	 (const Vector2& denPosition, const Vector2& position);
 		void GoToDen ();
 
 		void HuntSheep  (int sheepIndex);
@@ -57,15 +57,17 @@ namespace sim {
 		void SpawnWolfsDen (const Vector2& position);
 
 		void update (float dt);
-		void render (const Texture& texture) const;
+		void OnPerceptionEvent (const Perception::Event& event);
+		void render (SpriteBatch& batch) const;
 		
-		void RenderWolfsDen (const Texture& texture) const;
+		void RenderWolfsDen (SpriteBatch& batch) const;
 
 		void Sense	(State& state, float dt);
 		void Think	(State& state, float dt);
 		void Act	(State& state, float dt);
 
 		std::vector<Point> path;
+		std::vector<int>   sheepInRange; //Sorted, kept up to date by the world's perception events
 
 		State     currentState = Hungry;
 
@@ -88,14 +90,23 @@ namespace sim {
 		
 		bool	m_flip_x{};
 		bool    hasATarget	= false;
+		bool	senseDue	= false; //Set by the world's wake queue
+		bool	thinkDue	= false;
+		bool	herderNearby	= false;
+		bool	herderTooClose	= false;
 
 		int		amountSheepEaten	= 0;
 		int     sheepToHunt			= -1;
+		int		herderToAttack		= -1; //The closest herder while one is too close
+		int		id					= -1; //Index in the world's wolves
+		int		pack				= 0;  //Wolves of a pack share their den
 		
-		Timer senseTimer;
-		Timer thinkTimer;
 		Timer actTimer;
 
+		AgentPathStats pathStats; //Of its A* searches, shown in edit mode
+
+		Random random;
+
 		World* world = nullptr;
 
 	};
@@ -0,0 +1,53 @@
+//WorldConfig.h
+
+#pragma once
+
+#include <string_view>
+
+namespace sim {
+	//Tunables of one world, so worlds running side by side (ensembles, parameter sweeps) can each use their own values. The defaults are the values the game is balanced for.
+	struct WorldConfig {
+		//Name used on the command line ("--param sheep.grass_hunting_range=100,150") and in the ensemble output
+		struct Parameter {
+			const char*		   key		= nullptr;
+			float WorldConfig::* floatValue = nullptr;
+			int	  WorldConfig::* intValue	= nullptr;
+		};
+
+		static const Parameter PARAMETERS[];
+		static const int	   PARAMETER_COUNT;
+
+		bool Set (std::string_view key, float value); //Returns false for an unknown key
+		float Get (std::string_view key) const;
+
+		int	  startAmountSheep			= 5;
+		int	  startAmountWolves			= 1;
+		int	  startAmountHerders		= 1;
+		int	  worldColumns				= 0; //0 fits the world to the window, a map brings its own size
+		int	  worldRows					= 0;
+
+		float sheepAmountGrassSatiated	= 3.f;
+		float sheepDelayDefecating		= 3.0f;
+		float sheepDelayEating			= 2.0f;
+		float sheepTimeBeforeDamage		= 5.0f;
+		float sheepHealthRegeneration	= 2.0f;
+		float sheepSenseInterval		= 0.25f;
+		float sheepThinkInterval		= 0.5f;
+		float sheepGrassHuntingRange	= 150.0f;
+		float sheepFleeingRange			= 300.0f;
+
+		float wolfMaxHuntingDistance	= 200.f;
+		float wolfMaxWanderingDistance	= 300.f;
+		float wolfSleepTime				= 10.f;
+		float wolfDelayBetweenEating	= 3.f;
+		float wolfSenseInterval			= 0.5f;
+		float wolfThinkInterval			= 0.25f;
+		int	  wolfAmountSheepSatiated	= 3;
+		int	  wolfPackSize				= 3; //Wolves sharing one den
+
+		float grassNormalGrowSpeed		= 0.01f;
+		float grassFertilisedGrowSpeed	= 0.05f;
+
+		float manureMaxDuration			= 10.f;
+	};
+}
@@ -4,31 +4,137 @@
 
 #include "world.hpp"
 #include "editor.hpp"
+#include "Scheduler.h"
+#include "InputLog.h"
+#include "StateStream.h"
+#include "TripleBuffer.h"
+#include "simthread.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace sim
 {
+	// note: the simulation runs on a thread of its own and publishes a RenderSnapshot after every step. The main thread reads input, turns it into
+	// commands for the simulation and draws the newest snapshot, so a slow tick no longer lowers the frame rate and slow rendering no longer slows the simulation
 	struct AppState {
 		enum class Mode {
 			VIEW,
 			EDIT,
+			PLAYBACK, // note: showing a recorded state stream, nothing is simulated
 		};
 
+		enum class LogMode {
+			NONE,
+			RECORD,
+			REPLAY,
+		};
+
+		static constexpr int	TIME_SCALES[] = { 1, 4, 16, 0 }; // note: 0 runs as many ticks as fit in a step
+		static constexpr double FRAME_SECONDS	= 1.0 / World::TICKS_PER_SECOND; // note: also the length of a simulation step
+		static constexpr int	PLAYBACK_MAX_SCALE = 64; // note: "max" during playback, there is no tick budget to fill when nothing is simulated
+		static constexpr float	CAMERA_MIN_ZOOM		= 0.25f;
+		static constexpr float	CAMERA_MAX_ZOOM		= 4.0f;
+		static constexpr float	CAMERA_ZOOM_STEP	= 0.1f; // note: per wheel notch
+		static constexpr float	CAMERA_SCROLL_SPEED = 800.0f; // note: screen pixels per second, whatever the zoom
+		static constexpr const char* TRACE_PATH = "world.trace.json"; // note: where F8 traces to, unless --trace named a file
+
 		AppState ();
 
-		bool init (int width, int height);
+		bool record (const char* path); // note: all of these are called before init, a replay brings its own seed and map
+		bool replay (const char* path);
+		bool record_stream (const char* path);
+		bool play_stream (const char* path);
+		bool world_size (const char* size); // note: "columns x rows", e.g. "200x150"
+
+		bool init (int width, int height, uint64_t seed, const char* map_path = nullptr);
 		void shut ();
 		bool update (float dt);
 		void render () const;
+		void update_camera (float dt);
+		void post_world_input ();
+		void update_playback (float dt);
+		void render_playback () const;
+		Rectangle playback_bar () const;
+		void render_speed () const;
+		int  render_scheduler_stats (int y) const;
+		int  render_detail_stats (int y) const;
+		int  render_sprite_stats (int y) const;
+		int  render_overlay_stats (int y) const;
+		int  render_tick_costs (int y) const;
+		int  render_profiler (int y) const;
+		int  render_path_stats (int y) const;
+
+		Rectangle camera_view () const;
+
+		// note: simulation thread
+		void sim_loop ();
+		void sim_step (float dt);
+		void apply_command (const SimCommand& command);
+		void run_tick ();
+		void publish ();
 
 		bool m_running = true;
 
+		// note: main thread
 		Mode m_mode{};
-		
+
 		Texture m_texture{};
 		Texture	cursorTexture{};
-		
+
+		Camera2D m_camera{};
+		WorldConfig m_config; // note: what a new world starts from, a replay or playback brings its own
+
+		int	   m_time_scale = 0; // note: index into TIME_SCALES
+		Rectangle m_posted_view{};
+		mutable SpriteBatch::Stats m_sprite_stats; // note: of the world as drawn this frame
+		mutable std::vector<int> m_editor_sheep;
+
+		World m_view_world; // note: only ever shows snapshots, or stream frames in PLAYBACK mode
+
+		// note: between the threads
+		TripleBuffer<RenderSnapshot> m_snapshots;
+		SimCommandQueue	  m_commands;
+		std::thread		  m_sim_thread;
+		std::atomic<bool> m_sim_stopping{ false };
+		mutable std::mutex m_world_mutex; // note: held by the simulation during a step, and by the editor while it shows the (paused) world
+
+		// note: simulation thread, apart from what is set up before it starts
+		Mode   m_sim_mode{};
+		int	   m_sim_time_scale = 0;
+		double m_tick_accumulator = 0.0;
+		std::vector<SimCommand> m_applied_commands;
+
+		// note: readout, measured over the last second
+		int	   m_ticks_counted = 0;
+		double m_counted_seconds = 0.0;
+		double m_pass_seconds[World::PASS_COUNT]{};
+		double m_ticks_per_second = 0.0;
+		double m_tick_costs[World::PASS_COUNT]{}; // note: average milliseconds per tick
+		bool   m_budget_hit = false;
+
+		// note: input log being recorded or replayed
+		LogMode	 m_log_mode{};
+		InputLog m_input_log;
+		std::string m_log_path;
+		Rectangle m_recorded_view{};
+		size_t	 m_replay_cursor = 0;
+		bool	 m_replay_desynced = false;
+		uint64_t m_replay_desync_tick = 0;
+
+		// note: state stream being recorded, or played back in PLAYBACK mode
+		std::string	  m_stream_path;
+		StateRecorder m_state_recorder;
+		StatePlayer	  m_state_player;
+		double		  m_playback_frame = 0.0;
+		bool		  m_playback_paused = false;
+
+		std::string m_path_stats_path; // note: the world's A* telemetry is written here at shut, when set
+
+		Scheduler m_scheduler;
+
 		World m_world;
-		
+
 		Editor m_editor;
 	};
-}
\ No newline at end of file
+}
@@ -3,10 +3,14 @@
 #pragma once
 
 #include "common.hpp"
+#include "SpriteBatch.h"
+#include <array>
+#include <string>
 
 namespace sim
 {
 	struct World;
+	struct SimCommandQueue;
 
 	struct Editor {
 		enum Settings {
@@ -20,13 +24,46 @@ namespace sim
 			showHerderAndWolfPath,
 		};
 
+		// note: one of the world's Heatmap layers drawn over the ground, in the order of Heatmap::Layer
+		enum HeatmapSettings {
+			noHeatmap,
+			sheepPresenceHeatmap,
+			grassEatenHeatmap,
+			wolfKillsHeatmap,
+			pathExpansionsHeatmap,
+		};
+
+
+		static constexpr const char* SNAPSHOT_PATH = "world.snapshot";
+		static constexpr const char* MAP_PATH = "world.map";
+		static constexpr int MAX_LABELS = 48; // note: with more agents on screen only the hovered one gets its label, the text would cover the view anyway
+
+		// note: the label text is only formatted again when one of the values it shows changed, the key holds their bits
+		using LabelKey = std::array<uint32_t, 12>;
+		struct Label {
+			LabelKey key{};
+			std::string text;
+			bool valid = false;
+		};
+
+		// note: of the last frame, shown in edit mode
+		struct OverlayStats {
+			double seconds = 0.0; // note: cpu time of Editor::render
+			int labels = 0;
+			int labels_formatted = 0;
+			int path_quads = 0;
+			int heatmap_tiles = 0; // note: uploaded, in update_heatmap
+		};
 
 		Editor (World& world);
 
 		void init ();
 		void shut ();
 		bool update (float dt);
-		void render () const;
+		void render (const Rectangle& view, const std::vector<int>& visible_sheep) const; // note: the world has to be paused, the sheep come from the display world's render grid
+		void set_tile_active (bool active);
+		void update_heatmap (); // note: main thread, with the world paused
+		bool update_label (std::vector<Label>& labels, int index, const LabelKey& key) const; // note: true when labels[index] has to be formatted again
 
 		World& m_world;
 
@@ -37,5 +74,25 @@ namespace sim
 		int m_tile_index{};
 
 		Settings currentSettings = showAllPaths;
+		HeatmapSettings currentHeatmap = noHeatmap;
+
+		Texture2D m_heatmap_texture{}; // note: a pixel per tile, drawn as one quad over the world
+		std::vector<Color> m_heatmap_pixels;
+		std::vector<int> m_heatmap_dirty;
+		HeatmapSettings m_heatmap_uploaded = noHeatmap; // note: the layer the texture holds
+		uint32_t m_heatmap_scale = 0;
+
+		mutable std::vector<Label> m_sheep_labels;
+		mutable std::vector<Label> m_wolf_labels;
+		mutable std::vector<Label> m_herder_labels;
+		mutable std::vector<int> m_visible_wolves;
+		mutable std::vector<int> m_visible_herders;
+		mutable SpriteBatch m_path_batch; // note: all path tiles of one agent class in one draw
+		mutable OverlayStats m_overlay_stats;
+
+		const Camera2D* m_camera{}; // note: the app's camera, for picking tiles under the mouse
+		SimCommandQueue* m_commands{}; // note: edits go to the simulation thread, which applies and records them
+		bool m_recording{}; // note: recording an input log
+		bool m_locked{}; // note: replaying, the world only changes through the log
 	};
 }
@@ -0,0 +1,65 @@
+// ensemble.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "WorldConfig.h"
+#include "MapFile.h"
+#include "PathStats.h"
+#include <string>
+
+namespace sim
+{
+	struct Scheduler;
+
+	// note: runs many headless worlds side by side, one per seed and parameter combination, and writes a summary of how each one went
+	struct Ensemble {
+		struct Sweep {
+			std::string key;
+			std::vector<float> values;
+		};
+
+		struct Run {
+			uint64_t seed = 0;
+			WorldConfig config;
+		};
+
+		struct Result {
+			uint64_t ticks = 0;
+			double seconds = 0.0;
+			int sheep_alive = 0;
+			int sheep_peak = 0;
+			int sheep_born = 0;
+			int sheep_died = 0;
+			int grass_tiles = 0;
+			std::vector<int> sheep_curve; // note: living sheep every sample_ticks
+			std::vector<int> grass_curve;
+		};
+
+		static constexpr int WORLD_WIDTH = 1920;
+		static constexpr int WORLD_HEIGHT = 1080;
+
+		bool parse(int argc, char** argv); // note: false when the arguments are wrong
+		bool enabled() const { return seeds_per_combination > 0; }
+		void build_runs();
+		bool run(Scheduler& scheduler);
+		void run_one(int index, const MapFile* map);
+		bool write_summary() const;
+		bool write_curves() const;
+		bool write_path_stats() const;
+		void log_summary() const;
+
+		int seeds_per_combination = 0;
+		uint64_t first_seed = 1;
+		uint64_t ticks = 9000; // note: five minutes of game time
+		uint64_t sample_ticks = 300;
+		std::string out_path = "ensemble.csv";
+		std::string map_path;
+		std::string stream_path; // note: every run records a state stream, numbered after this path
+
+		std::vector<Sweep> sweeps;
+		std::vector<Run> runs;
+		std::vector<Result> results;
+		PathTelemetry path_stats; // note: the A* searches of all runs together
+	};
+}
@@ -0,0 +1,58 @@
+// simthread.hpp
+
+#pragma once
+
+#include "world.hpp"
+#include "Scheduler.h"
+#include <mutex>
+
+namespace sim
+{
+	// note: input of the main thread for the simulation thread, applied at the start of its next step
+	struct SimCommand {
+		enum Type {
+			SET_MODE,       // note: value: AppState::Mode, the world only ticks in VIEW
+			SET_TIME_SCALE, // note: value: index into AppState::TIME_SCALES
+			VIEW,           // note: x, y, width, height: camera view, for the level of detail
+			HERDER_INPUT,   // note: x, y: world position under the mouse, value: 1 when the button was just pressed
+			TILE_ACTIVE,    // note: x, y: tile coord
+			TILE_INACTIVE,
+			SAVE_SNAPSHOT,
+			LOAD_SNAPSHOT,
+			EXPORT_MAP,
+		};
+
+		Type type = SET_MODE;
+		int value = 0;
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 0.0f;
+		float height = 0.0f;
+	};
+
+	// note: a handful of commands per frame, so a mutex held for a push or a swap is all it takes
+	struct SimCommandQueue {
+		void post(const SimCommand& command);
+		void take(std::vector<SimCommand>& commands); // note: swaps the pending commands into commands, in the order they were posted
+
+		std::mutex mutex;
+		std::vector<SimCommand> pending;
+	};
+
+	// note: what the main thread needs to draw a frame, published by the simulation thread after every step
+	struct RenderSnapshot {
+		uint64_t tick = 0;
+		std::vector<int32_t> fields; // note: the world as a state stream frame: tile layers, agent positions and sprites
+
+		int detail_counts[Sheep::DETAIL_COUNT]{};
+		double tick_costs[World::PASS_COUNT]{}; // note: average milliseconds per tick over the last second
+		double ticks_per_second = 0.0;
+		bool budget_hit = false;
+		std::vector<Scheduler::WorkerStats> worker_stats;
+
+		int log_mode = 0; // note: AppState::LogMode
+		size_t log_length = 0; // note: ticks in the log being replayed
+		bool replay_desynced = false;
+		uint64_t replay_desync_tick = 0;
+	};
+}
@@ -10,32 +10,120 @@
 #include "Wolf.h"
 #include "Manure.h"
 #include "Tile.h"
+#include "CommandBuffer.h"
+#include "WakeQueue.h"
+#include "Perception.h"
+#include "Random.h"
+#include "Scheduler.h"
+#include "WorldConfig.h"
+#include "MapFile.h"
+#include "SpriteBatch.h"
+#include "Heatmap.h"
+#include "Profiler.h"
+#include "PathStats.h"
 #include "queue"
+#include <chrono>
 #include <stack>
 
 namespace sim
 {
 	struct Compare;
 	struct World {
+		using PathAgent = sim::PathAgent;
+
 		static constexpr int TILE_SIZE			= 32;
 		static constexpr int TILE_PADDING_X		= 3;
 		static constexpr int TILE_PADDING_Y		= 2;
-		static constexpr int START_AMOUNT_SHEEP	= 5;
+		static constexpr int BANDS_PER_THREAD	= 4;
+		static constexpr int SHEEP_PER_JOB		= 16;
+		static constexpr int TICKS_PER_SECOND	= 30; //Matches the target FPS, at 1x there is one world update per frame
+		static constexpr float TICK_SECONDS		= 1.f / TICKS_PER_SECOND;
+
+		static constexpr Vector2 FIRST_WOLFS_DEN	= {160.f, 160.f};
+		static constexpr Point	 FIRST_HERDER_TILE	= {21, 21};
+		static constexpr int	 HERDERS_PER_ROW	= 8; //Herders start on a grid, three tiles apart
+
+		static constexpr float DETAIL_VIEW_MARGIN = 2.f * TILE_SIZE; //Sheep switch to full detail a bit before they become visible
+
+		static constexpr int GROUND_CHUNK_TILES = 64; //The cached ground layer is split into square chunks, so big maps stay below the texture size limit
+		static constexpr float RENDER_MARGIN = 2.f * TILE_SIZE; //Sprites hang off their origin, so agents just outside the view can still reach into it
+
+		//Parts of the tick that get timed separately, for the per-tick cost breakdown
+		enum Pass {
+			GrassPass,
+			PerceptionPass,
+			SheepPass,
+			ManurePass,
+			HerderPass,
+			WolfPass,
+			CommandPass,
+			PASS_COUNT,
+		};
+
+		static_assert (profiler::CommandPass - profiler::GrassPass == CommandPass - GrassPass, "The profiler zones of the passes follow World::Pass");
+
+		static constexpr const char* PASS_NAMES[PASS_COUNT] = {"Grass", "Perception/wake", "Sheep", "Manure", "Herder", "Wolf", "Commands"};
 
 		static constexpr Rectangle CURSOR_NORMAL  = {0.f, 0.f, 16.f, 16.f};
 		static constexpr Rectangle CURSOR_BLOCKED = {16.f, 16.f, 16.f, 16.f};
 
 		World ();
 
-		void init	(int width, int height, Texture* texture, Texture* cursorTexture);
+		void init	(int width, int height, Texture* texture, Texture* cursorTexture, uint64_t seed, Scheduler* scheduler, const WorldConfig& config = {}, const MapFile* map = nullptr); //Without a map or a size in the config the world fills the window
 		void shut	();
 		bool update (float dt);
-		void render () const;
+		void render			(const Rectangle& view) const; //Only draws what overlaps the view, in world coordinates
+		void render_cursor	() const; //In screen space, after the camera mode ended
+		void prepare_render (); //Once per frame before drawing starts, outside of any texture or camera mode
+		void visible_tiles	(const Rectangle& view, Point& first, Point& last) const; //Tile coords overlapping the view, last is exclusive
+		void query_visible_sheep (const Rectangle& view, std::vector<int>& result) const; //Living sheep near the view, sorted
+
+		void redraw_ground_layer		();
+		void mark_ground_dirty			(int index);
+		void invalidate_ground_layer	(); //Redraws the whole layer next time, after the ground changed in bulk
+		void unload_ground_layer		();
+		Point ground_chunk_tiles		(const Point& chunk) const;
+		void draw_ground_tile			(int index, const Point& chunk) const;
+
+		int  RowBandCount		() const;
+		int  SheepJobCount		() const;
+		void RunTasks			();
+		void TakePassCosts		(double (&seconds)[PASS_COUNT]);
+
+		//Wraps a task so its time is added to the given pass, summed over all threads
+		template <typename Work>
+		auto Timed (Pass pass, Work work)
+		{
+			return [this, pass, work] (auto... arguments) {
+				PROFILE_SCOPE (profiler::Zone (profiler::GrassPass + (int)pass));
+				const auto start = std::chrono::steady_clock::now ();
+				work (arguments...);
+				m_pass_microseconds[pass] += std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start).count ();
+			};
+		}
+
+		void UpdateGrassBand		(float dt, int band);
+		void MergeGrassSpreading	();
+		void UpdateManureBand		(float dt, int band);
+		void MergeFertilising		();
+		void TakeSheepViews			();
+		void UpdateSheepJob			(float dt, int job);
+		void CommitSheepIntents		();
+		void PlaybackCommands		();
+
+		static int SecondsToTicks	(float seconds);
+		void ScheduleAgent			(WakeQueue::AgentType agent, int index);
+		void WakeAgents				();
+		void Perceive				();
+		void UpdateDetailLevels		();
+		void set_view				(const Rectangle& view);
 
 		bool is_valid_coord		(const Point& coord) const;
 		bool isSheepValid		(int sheepIndex) const;
 		bool IsAnotherSheep		(const Sheep& sheep1, const Sheep& sheep2) const;
 		bool is_walkable		(const Point& coord) const;
+		Point LastWalkableOnLine	(const Point& start, const Point& target) const; //The last tile before the straight line from start to target hits one that can't be walked on
+		Point NearestWalkableTile	(const Point& coord) const; //The coord itself if it is walkable, {-1, -1} if no tile is
 		bool has_grass_at		(const Point& coord) const;
 		bool isGrassFullyGrown  (const Point& coord) const;
 
@@ -59,15 +147,26 @@ namespace sim
 		bool  canSheepCurrentlyMate (int sheepIndex) const;
 		bool  isInRangeOfMating		(int sheepIndex, const Vector2& position) const;
 		
-		int		ReturnSheepToEat	();
-		bool	CanSheepBeEaten		(int sheepIndex);
-		void	EatSheep			(Sheep& sheep);
+		int		ReturnSheepToEat	(const Wolf& wolf);
+		bool	CanSheepBeEaten		(int wolfIndex, int sheepIndex);
+		void	EatSheep			(int sheepIndex);
+		bool	isWolfValid			(int wolfIndex) const;
+		bool	isHerderValid		(int herderIndex) const;
+		int		ClosestWolf			(const Vector2& position, float range) const; //-1 if none is in range, uses the positions of the last perception
+		int		ClosestHerder		(const Vector2& position, float range) const;
 		bool	IsWolfNearby		(const Point& coord) const;
 		bool	IsHerderNearby		(const Point& coord) const;
-		bool	IsHerderTooClose	(const Point& coord) const;
-		void	AttackHerder		();
+		int		HerderTooCloseTo	(const Point& coord) const; //The closest herder that is too close, -1 if none
+		void	AttackHerder		(int herderIndex);
+		int		HerderAt			(const Vector2& position) const;
+		void	SelectHerder		(int herderIndex);
+		void	MoveHerderTo		(const Vector2& position); //Moves the selected herder
+		bool	set_tile_active		(const Point& coord, bool active); //Walkable with grass, or a wall. Returns false if the tile already was
 
-		Point	getRandomTile (Vector2 startPosition, float range);
+		uint64_t Checksum () const; //Hash of the simulated state, for checking a replay stays in step
+
+		Point	getRandomTile (Vector2 startPosition, float range, Random& random);
+		Random	MakeRandom	  (Random::Stream stream, uint64_t entity, uint64_t subKey = 0) const;
 		
 		void  SetSheepAsMate (Sheep& sheep);
 		void  ResetSheepMate (Sheep& sheep);
@@ -77,15 +176,21 @@ namespace sim
 		void  Fertilise		(const Point& coord, const Point& nearbyTiles);
 		void  Defertilise	(const Point& coord, const Point& nearbyTiles);
 
-		bool	AStarPathFinding		(const Point& startNode, const Point& targetNode, std::vector<Point> &path);
+		PathStats AStarPathFinding		(const Point& startNode, const Point& targetNode, std::vector<Point> &path, const PathAgent& agent);
+		bool	SearchPath				(const Point& startNode, const Point& targetNode, std::vector<Point> &path, PathStats& stats);
 		float	CalculateHeuristicValue (Point tile, Point targetNode);
 		bool	ExploreNeighbours				(std::vector<bool>& searchedTiles, std::vector<Tile>& tiles, std::priority_queue<Tile, std::vector<Tile>, Compare>& frontier, const Point& nearbyTile, const Point& targetNode, const Point& searchStart);
 		
-		inline int GetIndex (const Point& coord) const;
+		int GetIndex (const Point& coord) const { return coord.y * m_world_size.x + coord.x; }
 		void	   GetPath  (std::vector<Point>& path, const std::vector<Tile>& tiles, const Point& targetNode);
 
 		bool m_running = true;
 
+		uint64_t m_seed = 0;
+		uint64_t m_tick = 0;
+
+		WorldConfig m_config;
+
 		Texture* m_texture{};
 		Texture* m_cursorTexture{};
 
@@ -94,14 +199,63 @@ namespace sim
 		Point m_world_offset;
 		
 		Rectangle m_world_bounds{};
+		Rectangle m_view_bounds{}; //Part of the world the camera sees
+
+		int m_detail_counts[Sheep::DETAIL_COUNT]{}; //Living sheep per level of detail, last tick
 
 		std::vector<Ground> m_ground;
 		std::vector<Grass>	m_grass;
 		std::vector<Sheep>	m_sheep;
 		std::vector<Manure> allManure;
 		
+		std::vector<Wolf>	m_wolves;
+		std::vector<Herder> m_herders;
+
+		int m_selected_herder = -1; //The herder the player's clicks move
+		
 		Manure manure;
-		Wolf wolf; 
-		Herder herder;
+
+		Scheduler* m_scheduler{}; //Owned by the AppState, without one the tasks run serially
+		TaskGraph  m_task_graph;
+
+		std::atomic<int64_t> m_pass_microseconds[PASS_COUNT]{}; //Since the last TakePassCosts
+
+		//Cross-tile writes of the tile layer passes, one buffer per row band so merging them in band order is deterministic
+		std::vector<std::vector<Point>>						m_grass_spread_requests;
+		std::vector<std::vector<Manure::FertiliseRequest>>	m_fertilise_requests;
+
+		//Frozen state of every sheep for the parallel sheep update, and which sheep claimed each mate while committing
+		std::vector<Sheep::View>	m_sheep_views;
+		std::vector<int>			m_mate_claims;
+
+		//Spawns, deaths, (un)pairing and attacks queued during the tick, played back once the agents are done
+		CommandBuffer m_commands;
+
+		//When each agent senses and thinks next, and the wake-ups popped this tick
+		WakeQueue					m_wake_queue;
+		std::vector<WakeQueue::WakeUp> m_due_wake_ups;
+
+		//Proximity changes between the agents, computed once per tick instead of every agent polling distances
+		Perception m_perception;
+
+		//Where things happened, for the editor's heatmap overlays. Not part of the simulated state, so neither checksummed nor saved
+		Heatmap			 m_heatmap;
+		std::vector<int> m_presence_tiles;
+
+		//Every A* search summed per agent kind and state, for the edit mode readout and the headless export. Not simulated state either
+		PathTelemetry m_path_telemetry;
+
+		//Walkable ground pre-rendered into chunks, only the tiles marked dirty since the last frame are drawn again
+		std::vector<RenderTexture2D> m_ground_chunks;
+		Point						 m_ground_chunk_count;
+		std::vector<int>			 m_dirty_ground;
+		std::vector<uint8_t>		 m_ground_dirty_flags;
+		bool						 m_ground_layer_stale = true;
+
+		mutable SpriteBatch m_sprite_batch; //Counts the quads and draws of every frame, which the app takes after rendering
+
+		//Living sheep by position as of the last prepare_render, the render passes only visit those in view
+		SpatialGrid		 m_render_grid;
+		mutable std::vector<int> m_visible_sheep;
 	};
 } // !sim
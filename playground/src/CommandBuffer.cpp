@@ -0,0 +1,28 @@
+//CommandBuffer.cpp
+
+#include "CommandBuffer.h"
+
+namespace sim {
+	void CommandBuffer::Push (Command::Type type, int target, const Vector2& position)
+	{
+		commands.push_back ({type, target, position});
+	}
+
+	void CommandBuffer::Clear ()
+	{
+		commands.clear ();
+	}
+
+	int CommandBuffer::Count (Command::Type type) const
+	{
+		int count = 0;
+		for (const Command& command : commands)
+		{
+			if (command.type == type)
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+}
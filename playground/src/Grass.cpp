@@ -47,7 +47,8 @@ namespace sim {
 
 
 	//note: Since the grass has very little states, which changes minimal things (mainly age) I chose to not further separate the sense-think-act for the grass entity. 
-	void Grass::Update (float dt) {
+	//note: Spreading to the surrounding tiles is only requested here, the world applies the requests after the (parallel) grass pass, since the neighbouring tiles may be updated by another thread
+	void Grass::Update (float dt, std::vector<Point>& spreadRequests) {
 		//is alive : sensing, if-statement: thinking, return: acting
 		if (!is_alive ())
 		{
@@ -60,7 +61,7 @@ namespace sim {
 			case Growing:
 			{
 				//Acting
-				set_age (m_age + NORMAL_GROW_SPEED * dt);
+				set_age (m_age + world->m_config.grassNormalGrowSpeed * dt);
 
 				//Sensing if it is fully grown, if-statement: thinking
 				if (isFullyGrown ())
@@ -82,7 +83,7 @@ namespace sim {
 			case Fertilised:
 			{
 				//Acting
-				set_age (m_age + FERTILISED_GROW_SPEED * dt);
+				set_age (m_age + world->m_config.grassFertilisedGrowSpeed * dt);
 				//Sensing if it is fully grown, if-statement: thinking
 				if (isFullyGrown ())
 				{
@@ -103,7 +104,7 @@ namespace sim {
 			case FullyGrown:
 			{
 				//Acting
-				set_age (m_age + NORMAL_GROW_SPEED * dt);
+				set_age (m_age + world->m_config.grassNormalGrowSpeed * dt);
 
 				//Sensing if the age is above a threshold, if-statement: thinking
 				if (m_age >= 0.84f)
@@ -136,11 +137,12 @@ namespace sim {
 					}
 				}
 
-				//Thinking which tiles will the grass spreads to
+				//Thinking which tiles will the grass spreads to (random stream keyed by tile and tick, so the update order does not matter)
+				Random random = world->MakeRandom (Random::GrassSpread, world->GetIndex (m_tile_coord), world->m_tick);
 				std::vector<Point> randomSurroundingTiles;
 				for (int i = 0; i < _countof (surroundingTiles); i++)
 				{
-					if (GetRandomValue (0, 100) > 50)
+					if (random.Range (0, 100) > 50)
 					{
 						randomSurroundingTiles.push_back (surroundingTiles[i]);
 					}
@@ -153,12 +155,8 @@ namespace sim {
 					{
 						continue;
 					}
-					//Thinking, based on the sense of has it grass
-					if (!world->has_grass_at (nearbyTiles))
-					{
-						//Acting
-						world->ReturnGrassAt (nearbyTiles).SpawnGrass ();
-					}
+					//Acting, whether the tile already has grass is checked when the request is applied
+					spreadRequests.push_back (nearbyTiles);
 				}
 
 				//Act
@@ -170,7 +168,7 @@ namespace sim {
 			case Wilting:
 			{
 				//Act
-				set_age (m_age + NORMAL_GROW_SPEED * dt);
+				set_age (m_age + world->m_config.grassNormalGrowSpeed * dt);
 
 				//Thinking, based on the information it senses from age
 				if (m_age >= 1.0f)
@@ -0,0 +1,72 @@
+//Heatmap.cpp
+
+#include "Heatmap.h"
+
+namespace sim {
+	void Heatmap::Init (int tileCount)
+	{
+		for (Counts& layer : layers)
+		{
+			std::lock_guard<std::mutex> lock (layer.mutex);
+			layer.counts.assign (tileCount, 0);
+			layer.dirty.clear ();
+			layer.dirtyFlags.assign (tileCount, 0);
+			layer.maxCount = 0;
+		}
+	}
+
+	static void Count (Heatmap::Counts& layer, int index)
+	{
+		const uint32_t count = ++layer.counts[index];
+		if (count > layer.maxCount)
+		{
+			layer.maxCount = count;
+		}
+		if (!layer.dirtyFlags[index])
+		{
+			layer.dirtyFlags[index] = 1;
+			layer.dirty.push_back (index);
+		}
+	}
+
+	void Heatmap::Record (Layer layer, int index)
+	{
+		Counts& counts = layers[layer];
+		std::lock_guard<std::mutex> lock (counts.mutex);
+		Count (counts, index);
+	}
+
+	void Heatmap::Record (Layer layer, const std::vector<int>& indices)
+	{
+		Counts& counts = layers[layer];
+		std::lock_guard<std::mutex> lock (counts.mutex);
+		for (int index : indices)
+		{
+			Count (counts, index);
+		}
+	}
+
+	void Heatmap::TakeDirty (Layer layer, std::vector<int>& indices)
+	{
+		Counts& counts = layers[layer];
+		indices.clear ();
+		std::lock_guard<std::mutex> lock (counts.mutex);
+		counts.dirty.swap (indices);
+		for (int index : indices)
+		{
+			counts.dirtyFlags[index] = 0;
+		}
+	}
+
+	uint32_t Heatmap::Scale (Layer layer)
+	{
+		Counts& counts = layers[layer];
+		std::lock_guard<std::mutex> lock (counts.mutex);
+		uint32_t scale = 1;
+		while (scale < counts.maxCount && scale < 0x80000000u)
+		{
+			scale <<= 1;
+		}
+		return scale;
+	}
+}
@@ -35,15 +35,15 @@ namespace sim {
 		m_source = source;
 	}
 
-	void Herder::Init ()
+	void Herder::Init (const Point& tile)
 	{
-		set_radius (25.f);
+		set_radius (RADIUS);
 		set_sprite_source (NORMAL_SOURCE);
 
 		Vector2 origin = Vector2{m_source.width / 3.f, m_source.height / 4.f};
 		set_sprite_origin (origin);
 
-		Vector2 position = world->tile_coord_to_position ({21,21});
+		Vector2 position = world->tile_coord_to_position (tile);
 		set_position (position);
 	}
 
@@ -67,16 +67,11 @@ namespace sim {
 			return;
 		}
 
-		//Set target
-		if (IsMouseButtonDown (MOUSE_BUTTON_LEFT))
-		{
-			targetCoord = world->position_to_tile_coord (GetMousePosition ());
-		}
-
+		//The target is set by the world (MoveHerderTo), from the player's clicks
 		//Search path to target
 		if (world->is_valid_coord (targetCoord))
 		{
-			world->AStarPathFinding (world->position_to_tile_coord (m_position), targetCoord, path);
+			pathStats.Add (world->AStarPathFinding (world->position_to_tile_coord (m_position), targetCoord, path, {World::PathAgent::HerderAgent, id}));
 		}
 
 		TraverseUsingPath (path);
@@ -90,7 +85,7 @@ namespace sim {
 		}
 	}
 
-	void Herder::Render (const Texture& texture) const {
+	void Herder::Render (SpriteBatch& batch) const {
 		Rectangle src = m_source;
 		float width = src.width;
 
@@ -104,12 +99,12 @@ namespace sim {
 		if (world->is_valid_coord (targetCoord) && !hasReachedDestination)
 		{
 			Rectangle destination = {world->tile_coord_to_position (targetCoord).x,world->tile_coord_to_position (targetCoord).y, 32.f, 32.f};
-			DrawTexturePro (texture, TARGET_FRAME_SOURCE, destination, {0.f, 0.f}, 0.0f, WHITE);
+			batch.Add (TARGET_FRAME_SOURCE, destination);
 		}
 
 		Rectangle dest = {m_position.x, m_position.y, width, src.height};
 		Vector2 origin = m_origin;
-		DrawTexturePro (texture, src, dest, origin, 0.0f, WHITE);
+		batch.Add (src, dest, origin);
 	}
 
 	void Herder::SetTargetPosition (const Vector2& position)
@@ -0,0 +1,287 @@
+//InputLog.cpp
+
+#include "InputLog.h"
+#include "world.hpp"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+
+namespace sim {
+	namespace inputlog {
+		struct Header {
+			uint32_t	magic	= InputLog::MAGIC;
+			uint32_t	version	= InputLog::VERSION;
+			int32_t		width	= 0;
+			int32_t		height	= 0;
+			uint64_t	seed	= 0;
+			WorldConfig config;
+			uint32_t	mapPathLength	= 0;
+			uint32_t	eventCount		= 0;
+			uint64_t	checksumCount	= 0;
+		};
+
+		//The config only holds 4 byte values, so it has no padding and can go to the file in one piece
+		static_assert (sizeof (WorldConfig) % 4 == 0 && alignof (WorldConfig) == 4);
+
+		//Fields are written one by one, so no padding bytes end up in the file and the format does not depend on how the compiler lays out the structs
+		struct Writer {
+			template <typename T>
+			void operator() (const T& value)
+			{
+				static_assert (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_same_v<T, WorldConfig>);
+				file.write ((const char*)&value, sizeof (T));
+			}
+
+			void operator() (const Header& header)
+			{
+				(*this) (header.magic);
+				(*this) (header.version);
+				(*this) (header.width);
+				(*this) (header.height);
+				(*this) (header.seed);
+				(*this) (header.config);
+				(*this) (header.mapPathLength);
+				(*this) (header.eventCount);
+				(*this) (header.checksumCount);
+			}
+
+			void operator() (const InputLog::Event& event)
+			{
+				(*this) (event.tick);
+				(*this) (event.type);
+				(*this) (event.x);
+				(*this) (event.y);
+				(*this) (event.width);
+				(*this) (event.height);
+			}
+
+			std::ofstream& file;
+		};
+
+		struct Reader {
+			template <typename T>
+			void operator() (T& value)
+			{
+				static_assert (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_same_v<T, WorldConfig>);
+				file.read ((char*)&value, sizeof (T));
+			}
+
+			void operator() (Header& header)
+			{
+				(*this) (header.magic);
+				(*this) (header.version);
+				(*this) (header.width);
+				(*this) (header.height);
+				(*this) (header.seed);
+				(*this) (header.config);
+				(*this) (header.mapPathLength);
+				(*this) (header.eventCount);
+				(*this) (header.checksumCount);
+			}
+
+			void operator() (InputLog::Event& event)
+			{
+				(*this) (event.tick);
+				(*this) (event.type);
+				(*this) (event.x);
+				(*this) (event.y);
+				(*this) (event.width);
+				(*this) (event.height);
+			}
+
+			std::ifstream& file;
+		};
+	}
+
+	void InputLog::Begin (int worldWidth, int worldHeight, uint64_t worldSeed, const WorldConfig& worldConfig, const char* worldMapPath)
+	{
+		width = worldWidth;
+		height = worldHeight;
+		seed = worldSeed;
+		config = worldConfig;
+		mapPath = worldMapPath ? worldMapPath : "";
+		events.clear ();
+		checksums.clear ();
+	}
+
+	void InputLog::Record (const Event& event)
+	{
+		events.push_back (event);
+	}
+
+	void InputLog::RecordChecksum (uint64_t tick, uint64_t checksum)
+	{
+		if (checksums.size () <= tick)
+		{
+			checksums.resize ((size_t)tick + 1);
+		}
+		checksums[(size_t)tick] = checksum;
+	}
+
+	void InputLog::Apply (const Event& event, World& world)
+	{
+		switch (event.type)
+		{
+		case Event::HerderTarget:
+			world.MoveHerderTo ({event.x, event.y});
+			break;
+		case Event::TileActive:
+		case Event::TileInactive:
+		{
+			const Point coord = {(int)event.x, (int)event.y};
+			if (world.is_valid_coord (coord))
+			{
+				world.set_tile_active (coord, event.type == Event::TileActive);
+			}
+			break;
+		}
+		case Event::SelectHerder:
+			world.SelectHerder ((int)event.x);
+			break;
+		case Event::View:
+			world.set_view ({event.x, event.y, event.width, event.height});
+			break;
+		case Event::ModeSwitch:
+			break;
+		}
+	}
+
+	void InputLog::ApplyDue (World& world, size_t& cursor) const
+	{
+		//Events of ticks that already passed can't be applied anymore, skipping them keeps the cursor in step
+		while (cursor < events.size () && events[cursor].tick <= world.m_tick)
+		{
+			if (events[cursor].tick == world.m_tick)
+			{
+				Apply (events[cursor], world);
+			}
+			cursor++;
+		}
+	}
+
+	bool InputLog::Verify (uint64_t tick, uint64_t checksum) const
+	{
+		return tick >= checksums.size () || checksums[(size_t)tick] == checksum;
+	}
+
+	bool InputLog::IsFinished (uint64_t tick, size_t cursor) const
+	{
+		return cursor >= events.size () && tick >= checksums.size ();
+	}
+
+	bool InputLog::SaveFile (const char* path) const
+	{
+		inputlog::Header header;
+		header.width = width;
+		header.height = height;
+		header.seed = seed;
+		header.config = config;
+		header.mapPathLength = (uint32_t)mapPath.size ();
+		header.eventCount = (uint32_t)events.size ();
+		header.checksumCount = checksums.size ();
+
+		std::ofstream file (path, std::ios::binary);
+		inputlog::Writer writer {file};
+		writer (header);
+		file.write (mapPath.data (), (std::streamsize)mapPath.size ());
+		for (const Event& event : events)
+		{
+			writer (event);
+		}
+		file.write ((const char*)checksums.data (), (std::streamsize)(checksums.size () * sizeof (uint64_t)));
+		if (!file)
+		{
+			TraceLog (LOG_WARNING, "INPUTLOG: Could not write '%s'", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool InputLog::LoadFile (const char* path)
+	{
+		std::ifstream file (path, std::ios::binary);
+		if (!file)
+		{
+			TraceLog (LOG_WARNING, "INPUTLOG: Could not open '%s'", path);
+			return false;
+		}
+
+		inputlog::Reader reader {file};
+		inputlog::Header header;
+		reader (header);
+		if (!file || header.magic != MAGIC || header.version != VERSION)
+		{
+			TraceLog (LOG_WARNING, "INPUTLOG: '%s' is not a version %u input log", path, VERSION);
+			return false;
+		}
+
+		std::string loadedMapPath (header.mapPathLength, '\0');
+		std::vector<Event> loadedEvents (header.eventCount);
+		std::vector<uint64_t> loadedChecksums ((size_t)header.checksumCount);
+		file.read (loadedMapPath.data (), (std::streamsize)loadedMapPath.size ());
+		for (Event& event : loadedEvents)
+		{
+			reader (event);
+		}
+		file.read ((char*)loadedChecksums.data (), (std::streamsize)(loadedChecksums.size () * sizeof (uint64_t)));
+		if (!file)
+		{
+			TraceLog (LOG_WARNING, "INPUTLOG: '%s' is truncated", path);
+			return false;
+		}
+
+		width = header.width;
+		height = header.height;
+		seed = header.seed;
+		config = header.config;
+		mapPath = std::move (loadedMapPath);
+		events = std::move (loadedEvents);
+		checksums = std::move (loadedChecksums);
+		return true;
+	}
+
+	bool InputLog::ReplayHeadless (const char* path, Scheduler* scheduler, const char* pathStatsPath)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		InputLog log;
+		if (!log.LoadFile (path))
+		{
+			return false;
+		}
+
+		MapFile map;
+		if (!log.mapPath.empty () && !map.Open (log.mapPath.c_str ()))
+		{
+			return false;
+		}
+
+		std::unique_ptr<World> world = std::make_unique<World> ();
+		world->init (log.width, log.height, nullptr, nullptr, log.seed, scheduler, log.config, log.mapPath.empty () ? nullptr : &map);
+
+		const Clock::time_point start = Clock::now ();
+		size_t cursor = 0;
+		while (!log.IsFinished (world->m_tick, cursor))
+		{
+			const uint64_t tick = world->m_tick;
+			log.ApplyDue (*world, cursor);
+			world->update (World::TICK_SECONDS);
+
+			if (!log.Verify (tick, world->Checksum ()))
+			{
+				TraceLog (LOG_ERROR, "INPUTLOG: '%s' desynced at tick %llu", path, (unsigned long long)tick);
+				return false;
+			}
+		}
+
+		const double seconds = std::chrono::duration<double> (Clock::now () - start).count ();
+		TraceLog (LOG_INFO, "INPUTLOG: '%s' replayed %llu ticks, %zu events in %.3f s (%.0f ticks/s)",
+			path,
+			(unsigned long long)world->m_tick,
+			log.events.size (),
+			seconds,
+			seconds > 0.0 ? (double)world->m_tick / seconds : 0.0);
+		return !pathStatsPath || world->m_path_telemetry.WriteCsv (pathStatsPath);
+	}
+}
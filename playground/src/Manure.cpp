@@ -46,7 +46,8 @@ namespace sim {
 	}
 
 	//note: Since the Manure has very little states, which changes minimal things (mainly age and being alive) I chose to not further separate the sense-think-act for the manure entity. 
-	void Manure::update (float dt)
+	//note: The neighbouring tiles are only (de)fertilised through requests, since they may be updated by another thread during the manure pass
+	void Manure::update (float dt, std::vector<FertiliseRequest>& fertiliseRequests)
 	{
 		//Sensing if the manure exists, based on that information it thinks (if it doesnt exist it should act), and acts (return)
 		if (!manureExists)
@@ -62,7 +63,7 @@ namespace sim {
 		world->CalculateNeighbouringTiles (m_position, surroundingTiles);
 
 		//Senses the duration and the max duration, and thinks if it should act
-		if (m_duration >= MAX_DURATION)
+		if (m_duration >= world->m_config.manureMaxDuration)
 		{
 			//Thinks which tiles are nearby
 			for (auto nearbyTiles : surroundingTiles)
@@ -73,7 +74,7 @@ namespace sim {
 					continue;
 				}
 				//Acting
-				world->Defertilise (tileCoord, nearbyTiles);
+				fertiliseRequests.push_back ({tileCoord, nearbyTiles, false});
 			}
 			//Acting
 			DespawnManure ();
@@ -87,12 +88,13 @@ namespace sim {
 		}
 
 		std::vector<Point> randomSurroundingTiles;
+		Random random = world->MakeRandom (Random::ManureSpread, world->GetIndex (tileCoord), world->m_tick);
 
 		//Thinks which tiles to add to the vector
 		for (int i = 0; i < _countof (surroundingTiles); i++)
 		{
 			//Sensing which random value it is, thinking if it is true and thus if it should act
-			if (GetRandomValue (0, 100) > 50)
+			if (random.Range (0, 100) > 50)
 			{
 				//Acting
 				randomSurroundingTiles.push_back (surroundingTiles[i]);
@@ -106,24 +108,20 @@ namespace sim {
 			{
 				continue;
 			}
-			//Senses if the ground is fertilised, then thinks if it should act based on this information
-			if (!world->IsGroundFertilised (nearbyTiles))
-			{
-				//Acting
-				world->Fertilise (tileCoord, nearbyTiles);
-			}
+			//Acting, whether the ground is already fertilised is sensed when the request is applied
+			fertiliseRequests.push_back ({tileCoord, nearbyTiles, true});
 		}
 
 		//Acting
 		hasFertilised = true;
 	}
 
-	void Manure::render (const Texture& texture) const
+	void Manure::render (SpriteBatch& batch) const
 	{
 		Rectangle source = m_source;
 		float width = source.width;
 		Vector2 originManure = origin;
 		Rectangle destination = {m_position.x + source.width, m_position.y + source.height, 16.f, 16.f};
-		DrawTexturePro (texture, m_source, destination, originManure, 0.0f, WHITE);
+		batch.Add (m_source, destination, originManure);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+//MapFile.cpp
+
+#include "MapFile.h"
+#include "world.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace sim {
+	namespace map {
+		uint64_t Align (uint64_t offset)
+		{
+			return (offset + 7) & ~uint64_t (7);
+		}
+
+		bool TestBit (const uint8_t* bits, int index)
+		{
+			return (bits[index >> 3] >> (index & 7)) & 1;
+		}
+
+		bool FitsIn (uint64_t offset, uint64_t length, uint64_t size)
+		{
+			return offset <= size && length <= size - offset;
+		}
+	}
+
+	bool MapFile::Open (const char* path)
+	{
+		Close ();
+		if (!file.Open (path))
+		{
+			TraceLog (LOG_WARNING, "MAP: Could not open '%s'", path);
+			return false;
+		}
+
+		// note: only the header and the block bounds are checked, the tiles themselves are paged in when they are read
+		const Header* candidate = (const Header*)file.data;
+		const uint64_t size = file.size;
+		bool valid = size >= sizeof (Header) && candidate->magic == MAGIC && candidate->version == VERSION && candidate->columns > 0 && candidate->rows > 0;
+
+		if (valid)
+		{
+			const uint64_t tiles = (uint64_t)candidate->columns * (uint64_t)candidate->rows;
+			const uint64_t bitsetSize = (tiles + 7) / 8;
+			valid &= map::FitsIn (candidate->walkabilityOffset, bitsetSize, size);
+			if (candidate->layers & GrassLayer)
+			{
+				valid &= map::FitsIn (candidate->grassOffset, tiles, size);
+			}
+			if (candidate->layers & FertilityLayer)
+			{
+				valid &= map::FitsIn (candidate->fertilityOffset, bitsetSize, size);
+			}
+		}
+
+		if (!valid)
+		{
+			TraceLog (LOG_WARNING, "MAP: '%s' is not a version %u map", path, VERSION);
+			Close ();
+			return false;
+		}
+
+		header = candidate;
+		TraceLog (LOG_INFO, "MAP: Mapped '%s', %dx%d tiles", path, header->columns, header->rows);
+		return true;
+	}
+
+	void MapFile::Close ()
+	{
+		header = nullptr;
+		file.Close ();
+	}
+
+	bool MapFile::IsWalkable (int index) const
+	{
+		return map::TestBit (file.data + header->walkabilityOffset, index);
+	}
+
+	bool MapFile::IsFertilised (int index) const
+	{
+		return HasLayer (FertilityLayer) && map::TestBit (file.data + header->fertilityOffset, index);
+	}
+
+	float MapFile::GrassAge (int index) const
+	{
+		if (!HasLayer (GrassLayer))
+		{
+			return 0.f;
+		}
+
+		const uint8_t value = file.data[header->grassOffset + index];
+		return value == 0 ? 0.f : (float)value / 255.f;
+	}
+
+	bool MapFile::Export (const World& world, const char* path)
+	{
+		const int tiles = world.m_world_size.x * world.m_world_size.y;
+		const uint64_t bitsetSize = (uint64_t (tiles) + 7) / 8;
+
+		Header header;
+		header.columns = world.m_world_size.x;
+		header.rows = world.m_world_size.y;
+		header.layers = GrassLayer | FertilityLayer;
+		header.walkabilityOffset = map::Align (sizeof (Header));
+		header.grassOffset = map::Align (header.walkabilityOffset + bitsetSize);
+		header.fertilityOffset = map::Align (header.grassOffset + tiles);
+
+		std::vector<uint8_t> bytes (map::Align (header.fertilityOffset + bitsetSize), 0);
+		std::memcpy (bytes.data (), &header, sizeof (Header));
+
+		for (int i = 0; i < tiles; i++)
+		{
+			if (world.m_ground[i].is_walkable ())
+			{
+				bytes[header.walkabilityOffset + (i >> 3)] |= uint8_t (1 << (i & 7));
+			}
+			if (world.m_ground[i].fertilised)
+			{
+				bytes[header.fertilityOffset + (i >> 3)] |= uint8_t (1 << (i & 7));
+			}
+
+			// note: living grass always stores at least 1, 0 is reserved for no grass
+			const float age = world.m_grass[i].get_age ();
+			if (age > 0.f)
+			{
+				bytes[header.grassOffset + i] = (uint8_t)Math::clamp ((int)std::lround (age * 255.f), 1, 255);
+			}
+		}
+
+		std::ofstream file (path, std::ios::binary);
+		if (!file.write ((const char*)bytes.data (), (std::streamsize)bytes.size ()))
+		{
+			TraceLog (LOG_WARNING, "MAP: Could not write '%s'", path);
+			return false;
+		}
+
+		TraceLog (LOG_INFO, "MAP: Exported %dx%d tiles to '%s'", header.columns, header.rows, path);
+		return true;
+	}
+}
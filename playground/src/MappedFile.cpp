@@ -0,0 +1,125 @@
+//MappedFile.cpp
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sim {
+	MappedFile::~MappedFile ()
+	{
+		Close ();
+	}
+
+#if defined(_WIN32)
+	bool MappedFile::Open (const char* path)
+	{
+		Close ();
+
+		HANDLE file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx (file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close ();
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			Close ();
+			return false;
+		}
+		mappingHandle = mapping;
+
+		data = (const uint8_t*)MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+		{
+			Close ();
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close ()
+	{
+		if (data)
+		{
+			UnmapViewOfFile (data);
+		}
+		if (mappingHandle)
+		{
+			CloseHandle ((HANDLE)mappingHandle);
+		}
+		if (fileHandle)
+		{
+			CloseHandle ((HANDLE)fileHandle);
+		}
+
+		data = nullptr;
+		size = 0;
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+	}
+#else
+	bool MappedFile::Open (const char* path)
+	{
+		Close ();
+
+		const int file = open (path, O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+		descriptor = file;
+
+		struct stat status{};
+		if (fstat (file, &status) != 0 || status.st_size == 0)
+		{
+			Close ();
+			return false;
+		}
+
+		void* mapping = mmap (nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED)
+		{
+			Close ();
+			return false;
+		}
+		data = (const uint8_t*)mapping;
+		size = (size_t)status.st_size;
+		return true;
+	}
+
+	void MappedFile::Close ()
+	{
+		if (data)
+		{
+			munmap ((void*)data, size);
+		}
+		if (descriptor >= 0)
+		{
+			close ((int)descriptor);
+		}
+
+		data = nullptr;
+		size = 0;
+		descriptor = -1;
+	}
+#endif
+}
@@ -0,0 +1,133 @@
+//PathStats.cpp
+
+#include "PathStats.h"
+#include <raylib.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace sim {
+	void AgentPathStats::Add (const PathStats& search)
+	{
+		searches++;
+		failures += search.found ? 0 : 1;
+		lastMicroseconds = (float)search.microseconds;
+		lastExpanded = search.expanded;
+	}
+
+	double PathTelemetry::Bucket::Percentile (double fraction) const
+	{
+		if (searches == 0)
+		{
+			return 0.0;
+		}
+
+		const uint64_t rank = (uint64_t)std::ceil (fraction * (double)searches);
+		uint64_t counted = 0;
+		int bucket = 0;
+		for (; bucket < LATENCY_BUCKETS - 1; bucket++)
+		{
+			counted += latency[bucket];
+			if (counted >= rank)
+			{
+				break;
+			}
+		}
+		return std::exp2 ((double)(bucket + 1) / BUCKETS_PER_OCTAVE) - 1.0;
+	}
+
+	void PathTelemetry::Record (const PathAgent& agent, const PathStats& search)
+	{
+		const int state = std::clamp (agent.state, 0, STATE_COUNTS[agent.kind] - 1);
+		const int latencyBucket = std::min ((int)(BUCKETS_PER_OCTAVE * std::log2 (1.0 + search.microseconds)), LATENCY_BUCKETS - 1);
+
+		std::lock_guard<std::mutex> lock (mutex);
+		Bucket& bucket = buckets[agent.kind][state];
+		bucket.searches++;
+		bucket.failures += search.found ? 0 : 1;
+		bucket.expanded += search.expanded;
+		bucket.frontierPushes += search.frontierPushes;
+		bucket.stalePops += search.stalePops;
+		bucket.pathLength += search.found ? search.pathLength : 0;
+		bucket.microseconds += search.microseconds;
+		bucket.latency[latencyBucket]++;
+	}
+
+	void PathTelemetry::Merge (const PathTelemetry& other)
+	{
+		Table table;
+		other.Copy (table);
+
+		std::lock_guard<std::mutex> lock (mutex);
+		for (int kind = 0; kind < PathAgent::KIND_COUNT; kind++)
+		{
+			for (int state = 0; state < MAX_STATES; state++)
+			{
+				Bucket& bucket = buckets[kind][state];
+				const Bucket& added = table[kind][state];
+				bucket.searches += added.searches;
+				bucket.failures += added.failures;
+				bucket.expanded += added.expanded;
+				bucket.frontierPushes += added.frontierPushes;
+				bucket.stalePops += added.stalePops;
+				bucket.pathLength += added.pathLength;
+				bucket.microseconds += added.microseconds;
+				for (int i = 0; i < LATENCY_BUCKETS; i++)
+				{
+					bucket.latency[i] += added.latency[i];
+				}
+			}
+		}
+	}
+
+	void PathTelemetry::Copy (Table& table) const
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		std::copy (&buckets[0][0], &buckets[0][0] + PathAgent::KIND_COUNT * MAX_STATES, &table[0][0]);
+	}
+
+	void PathTelemetry::Clear ()
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		std::fill (&buckets[0][0], &buckets[0][0] + PathAgent::KIND_COUNT * MAX_STATES, Bucket {});
+	}
+
+	bool PathTelemetry::WriteCsv (const char* path) const
+	{
+		std::ofstream file (path);
+		if (!file)
+		{
+			TraceLog (LOG_ERROR, "PATHSTATS: Could not write '%s'", path);
+			return false;
+		}
+
+		Table table;
+		Copy (table);
+
+		file << "agent,state,searches,failed,expanded_avg,frontier_pushes_avg,stale_pops_avg,path_length_avg,us_avg,us_p50,us_p95,us_p99\n";
+		for (int kind = 0; kind < PathAgent::KIND_COUNT; kind++)
+		{
+			for (int state = 0; state < STATE_COUNTS[kind]; state++)
+			{
+				const Bucket& bucket = table[kind][state];
+				const double searches = (double)std::max (bucket.searches, (uint64_t)1);
+				const double found = (double)std::max (bucket.searches - bucket.failures, (uint64_t)1);
+				file << KIND_NAMES[kind] << ',' << STATE_NAMES[kind][state]
+					 << ',' << bucket.searches
+					 << ',' << bucket.failures
+					 << ',' << bucket.expanded / searches
+					 << ',' << bucket.frontierPushes / searches
+					 << ',' << bucket.stalePops / searches
+					 << ',' << bucket.pathLength / found
+					 << ',' << bucket.microseconds / searches
+					 << ',' << bucket.Percentile (0.50)
+					 << ',' << bucket.Percentile (0.95)
+					 << ',' << bucket.Percentile (0.99)
+					 << '\n';
+			}
+		}
+
+		TraceLog (LOG_INFO, "PATHSTATS: Wrote '%s'", path);
+		return true;
+	}
+}
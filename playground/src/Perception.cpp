@@ -0,0 +1,143 @@
+//Perception.cpp
+
+#include "Perception.h"
+#include "world.hpp"
+#include <algorithm>
+
+namespace sim {
+	void Perception::Reset ()
+	{
+		m_events.clear ();
+		m_sheep_in_hunting_range.clear ();
+		m_sheep_tiles.clear ();
+		m_herder_nearby.clear ();
+		m_herder_too_close.clear ();
+	}
+
+	void Perception::AddEvent (Event::Type type, WakeQueue::AgentType receiver, int receiverIndex, int subject, int source)
+	{
+		m_events.push_back ({type, receiver, receiverIndex, subject, source});
+	}
+
+	void Perception::Update (World& world)
+	{
+		m_events.clear ();
+
+		// note: spatial indices of the living sheep, the wolves and the herders
+		m_sheep_grid.Begin (world.m_world_bounds, CELL_SIZE);
+		for (int i = 0; i < (int)world.m_sheep.size (); i++)
+		{
+			if (world.m_sheep[i].isAlive)
+			{
+				m_sheep_grid.Add (i, world.m_sheep[i].m_position);
+			}
+		}
+		m_sheep_grid.Finish ();
+
+		m_wolf_grid.Begin (world.m_world_bounds, CELL_SIZE);
+		for (const Wolf& wolf : world.m_wolves)
+		{
+			m_wolf_grid.Add (wolf.id, wolf.m_position);
+		}
+		m_wolf_grid.Finish ();
+
+		m_herder_grid.Begin (world.m_world_bounds, CELL_SIZE);
+		for (const Herder& herder : world.m_herders)
+		{
+			m_herder_grid.Add (herder.id, herder.m_position + herder.m_origin);
+		}
+		m_herder_grid.Finish ();
+
+		const int wolfCount = (int)world.m_wolves.size ();
+		m_sheep_in_hunting_range.resize (wolfCount);
+		m_herder_nearby.resize (wolfCount, 0);
+		m_herder_too_close.resize (wolfCount, -1);
+
+		for (int wolf = 0; wolf < wolfCount; wolf++)
+		{
+			const Vector2 wolfPosition = world.m_wolves[wolf].m_position;
+
+			{ // note: wolf <-> sheep, both sorted so the difference gives the sheep that entered and left
+				std::vector<int>& inRange = m_sheep_in_hunting_range[wolf];
+				m_query_result.clear ();
+				m_sheep_grid.Query (wolfPosition, world.m_config.wolfMaxHuntingDistance, m_query_result);
+
+				auto previous = inRange.begin ();
+				auto current = m_query_result.begin ();
+				while (previous != inRange.end () || current != m_query_result.end ())
+				{
+					if (current == m_query_result.end () || (previous != inRange.end () && *previous < *current))
+					{
+						AddEvent (Event::SheepLeftHuntingRange, WakeQueue::WolfAgent, wolf, *previous, wolf);
+						AddEvent (Event::SheepLeftHuntingRange, WakeQueue::SheepAgent, *previous, *previous, wolf);
+						++previous;
+					}
+					else if (previous == inRange.end () || *current < *previous)
+					{
+						AddEvent (Event::SheepEnteredHuntingRange, WakeQueue::WolfAgent, wolf, *current, wolf);
+						++current;
+					}
+					else
+					{
+						++previous;
+						++current;
+					}
+				}
+				inRange.swap (m_query_result);
+			}
+
+			{ // note: wolf <-> herder
+				const Point wolfCoord = world.position_to_tile_coord (wolfPosition);
+				const bool herderNearby = world.IsHerderNearby (wolfCoord);
+				const int herderTooClose = world.HerderTooCloseTo (wolfCoord);
+
+				if (herderNearby != (m_herder_nearby[wolf] != 0))
+				{
+					AddEvent (herderNearby ? Event::HerderEnteredNearby : Event::HerderLeftNearby, WakeQueue::WolfAgent, wolf);
+				}
+
+				//Another herder coming closer than the one the wolf was after counts as entering too
+				if (herderTooClose != m_herder_too_close[wolf])
+				{
+					AddEvent (herderTooClose != -1 ? Event::HerderEnteredTooClose : Event::HerderLeftTooClose, WakeQueue::WolfAgent, wolf, -1, herderTooClose);
+				}
+				m_herder_nearby[wolf] = herderNearby ? 1 : 0;
+				m_herder_too_close[wolf] = herderTooClose;
+			}
+		}
+
+		{ // note: sheep <-> grass, only looked at when a sheep steps onto another tile
+			m_sheep_tiles.resize (world.m_sheep.size (), {-1, -1});
+			for (int i = 0; i < (int)world.m_sheep.size (); i++)
+			{
+				const Sheep& sheep = world.m_sheep[i];
+				const Point tile = world.position_to_tile_coord (sheep.m_position);
+				if (!sheep.isAlive || tile == m_sheep_tiles[i])
+				{
+					continue;
+				}
+
+				m_sheep_tiles[i] = tile;
+				if (world.is_valid_coord (tile) && world.CanGrassBeEaten (sheep.m_position))
+				{
+					AddEvent (Event::GrassReached, WakeQueue::SheepAgent, i, i);
+				}
+			}
+		}
+	}
+
+	void Perception::Deliver (World& world) const
+	{
+		for (const Event& event : m_events)
+		{
+			if (event.receiver == WakeQueue::WolfAgent)
+			{
+				world.m_wolves[event.receiverIndex].OnPerceptionEvent (event);
+			}
+			else
+			{
+				world.m_sheep[event.receiverIndex].OnPerceptionEvent (event);
+			}
+		}
+	}
+}
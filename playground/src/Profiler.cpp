@@ -0,0 +1,97 @@
+//Profiler.cpp
+
+#include "Profiler.h"
+#include <algorithm>
+#include <mutex>
+
+namespace sim {
+	namespace profiler {
+		std::atomic<int64_t> zoneNanoseconds[ZONE_COUNT]{};
+
+		//Written by the thread ending a frame, read by the one drawing the stats
+		static std::mutex historyMutex;
+		static float	  history[ZONE_COUNT][HISTORY_FRAMES]{};
+		static int		  historyCount[ZONE_COUNT]{};
+		static int		  historyNext[ZONE_COUNT]{};
+
+		Zone RootOf (Zone zone)
+		{
+			while (ZONES[zone].parent != NO_PARENT)
+			{
+				zone = (Zone)ZONES[zone].parent;
+			}
+			return zone;
+		}
+
+		int DepthOf (Zone zone)
+		{
+			int depth = 0;
+			while (ZONES[zone].parent != NO_PARENT)
+			{
+				zone = (Zone)ZONES[zone].parent;
+				depth++;
+			}
+			return depth;
+		}
+
+		void EndFrame (Zone root)
+		{
+			//The roots have no scope of their own, they took what their children did
+			int64_t nanoseconds[ZONE_COUNT]{};
+			for (int zone = 0; zone < ZONE_COUNT; zone++)
+			{
+				if (zone != root && RootOf ((Zone)zone) == root)
+				{
+					nanoseconds[zone] = zoneNanoseconds[zone].exchange (0, std::memory_order_relaxed);
+					if (ZONES[zone].parent == root)
+					{
+						nanoseconds[root] += nanoseconds[zone];
+					}
+				}
+			}
+
+			std::lock_guard<std::mutex> lock (historyMutex);
+			for (int zone = 0; zone < ZONE_COUNT; zone++)
+			{
+				if (RootOf ((Zone)zone) != root)
+				{
+					continue;
+				}
+				history[zone][historyNext[zone]] = float (double (nanoseconds[zone]) / 1e6);
+				historyNext[zone] = (historyNext[zone] + 1) % HISTORY_FRAMES;
+				historyCount[zone] = std::min (historyCount[zone] + 1, HISTORY_FRAMES);
+			}
+		}
+
+		void TakeStats (ZoneStats (&stats)[ZONE_COUNT])
+		{
+			float samples[HISTORY_FRAMES];
+
+			std::lock_guard<std::mutex> lock (historyMutex);
+			for (int zone = 0; zone < ZONE_COUNT; zone++)
+			{
+				const int count = historyCount[zone];
+				stats[zone] = {};
+				if (count == 0)
+				{
+					continue;
+				}
+
+				std::copy (history[zone], history[zone] + count, samples);
+				double sum = 0.0;
+				for (int i = 0; i < count; i++)
+				{
+					sum += samples[i];
+				}
+
+				const int p99 = std::min (count - 1, count * 99 / 100);
+				std::nth_element (samples, samples + p99, samples + count);
+
+				stats[zone].last = history[zone][(historyNext[zone] + HISTORY_FRAMES - 1) % HISTORY_FRAMES];
+				stats[zone].min	 = *std::min_element (samples, samples + count);
+				stats[zone].avg	 = sum / count;
+				stats[zone].p99	 = samples[p99];
+			}
+		}
+	}
+}
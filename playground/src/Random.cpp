@@ -0,0 +1,47 @@
+//Random.cpp
+
+#include "Random.h"
+
+namespace sim {
+	static constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+	Random::Random (uint64_t seed, Stream stream, uint64_t entity, uint64_t subKey)
+	{
+		//Hashing every part of the key separately, so neighbouring entities/ticks end up in unrelated streams
+		key = Mix (seed + GOLDEN_GAMMA * (uint64_t (stream) + 1));
+		key = Mix (key ^ entity);
+		key = Mix (key ^ Mix (subKey));
+	}
+
+	uint64_t Random::Mix (uint64_t value)
+	{
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	uint64_t Random::Next ()
+	{
+		counter++;
+		return Mix (key + counter * GOLDEN_GAMMA);
+	}
+
+	int Random::Range (int min, int max)
+	{
+		if (min > max)
+		{
+			const int temp = min;
+			min = max;
+			max = temp;
+		}
+
+		const uint64_t range = uint64_t (int64_t (max) - int64_t (min)) + 1;
+		return int (int64_t (min) + int64_t (Next () % range));
+	}
+
+	float Random::Float ()
+	{
+		//Using the top 24 bits, which is exactly the precision of a float mantissa
+		return float (Next () >> 40) * (1.0f / 16777216.0f);
+	}
+}
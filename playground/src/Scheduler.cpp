@@ -0,0 +1,320 @@
+//Scheduler.cpp
+
+#include "Scheduler.h"
+#include "Trace.h"
+#include <cassert>
+#include <chrono>
+
+namespace sim {
+	using Clock = std::chrono::steady_clock;
+
+	int TaskGraph::AddTask (int job, int index, std::initializer_list<int> dependencies)
+	{
+		//Reusing the task slots of previous frames, so their dependents vectors keep their capacity
+		if (taskCount == (int)tasks.size ())
+		{
+			tasks.emplace_back ();
+		}
+
+		const int id = taskCount++;
+		Task& task = tasks[id];
+		task.job = job;
+		task.index = index;
+		task.dependencyCount = 0;
+		task.dependents.clear ();
+
+		for (int dependency : dependencies)
+		{
+			assert (dependency >= 0 && dependency < id);
+			tasks[dependency].dependents.push_back (id);
+			task.dependencyCount++;
+		}
+		return id;
+	}
+
+	int TaskGraph::Add (std::function<void ()> work, std::initializer_list<int> dependencies)
+	{
+		jobs.push_back ([work = std::move (work)] (int) { work (); });
+		return AddTask ((int)jobs.size () - 1, 0, dependencies);
+	}
+
+	int TaskGraph::AddParallelFor (int count, std::function<void (int)> job, std::initializer_list<int> dependencies)
+	{
+		if (count <= 0)
+		{
+			return AddTask (-1, 0, dependencies);
+		}
+
+		jobs.push_back (std::move (job));
+		const int jobIndex = (int)jobs.size () - 1;
+
+		const int first = taskCount;
+		for (int i = 0; i < count; i++)
+		{
+			AddTask (jobIndex, i, dependencies);
+		}
+
+		//Joining all indices in one empty task, which is what later tasks depend on
+		const int join = AddTask (-1, 0, {});
+		for (int task = first; task < join; task++)
+		{
+			tasks[task].dependents.push_back (join);
+			tasks[join].dependencyCount++;
+		}
+		return join;
+	}
+
+	void TaskGraph::Clear ()
+	{
+		jobs.clear ();
+		taskCount = 0;
+	}
+
+	void TaskGraph::Execute (int task) const
+	{
+		const Task& entry = tasks[task];
+		if (entry.job >= 0)
+		{
+			jobs[entry.job] (entry.index);
+		}
+	}
+
+	void TaskGraph::RunSerial () const
+	{
+		for (int task = 0; task < taskCount; task++)
+		{
+			Execute (task);
+		}
+	}
+
+	Scheduler::~Scheduler ()
+	{
+		Stop ();
+	}
+
+	void Scheduler::Start (int workerThreads)
+	{
+		Stop ();
+		stopping = false;
+
+		workers.clear ();
+		for (int i = 0; i < workerThreads + 1; i++)
+		{
+			workers.push_back (std::make_unique<Worker> ());
+		}
+		lastFrameStats.assign (workers.size (), {});
+
+		for (int i = 1; i <= workerThreads; i++)
+		{
+			threads.emplace_back ([this, i] { WorkerLoop (i); });
+		}
+	}
+
+	void Scheduler::Stop ()
+	{
+		{
+			std::lock_guard<std::mutex> lock (sleepMutex);
+			stopping = true;
+		}
+		wake.notify_all ();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join ();
+		}
+		threads.clear ();
+	}
+
+	int Scheduler::WorkerCount () const
+	{
+		return workers.empty () ? 1 : (int)workers.size ();
+	}
+
+	void Scheduler::Run (const TaskGraph& taskGraph)
+	{
+		if (taskGraph.Size () == 0)
+		{
+			return;
+		}
+
+		//Without worker threads there is nobody to share with
+		if (threads.empty ())
+		{
+			const Clock::time_point start = Clock::now ();
+			taskGraph.RunSerial ();
+
+			const double seconds = std::chrono::duration<double> (Clock::now () - start).count ();
+			frameRunSeconds += seconds;
+			if (!workers.empty ())
+			{
+				workers[0]->tasksRun += (uint64_t)taskGraph.Size ();
+				workers[0]->busyMicroseconds += (int64_t)(seconds * 1e6);
+			}
+			return;
+		}
+
+		assert (graph == nullptr && "Scheduler::Run is not reentrant");
+		const Clock::time_point start = Clock::now ();
+
+		if (pendingCapacity < taskGraph.Size ())
+		{
+			pendingCapacity = taskGraph.Size ();
+			pendingDependencies = std::make_unique<std::atomic<int>[]> (pendingCapacity);
+		}
+		for (int task = 0; task < taskGraph.Size (); task++)
+		{
+			pendingDependencies[task] = taskGraph.tasks[task].dependencyCount;
+		}
+
+		graph = &taskGraph;
+		remainingTasks = taskGraph.Size ();
+
+		//The ready tasks all go into the queue of the calling thread, the workers steal them from there
+		for (int task = 0; task < taskGraph.Size (); task++)
+		{
+			if (taskGraph.tasks[task].dependencyCount == 0)
+			{
+				Push (0, task);
+			}
+		}
+
+		while (remainingTasks > 0)
+		{
+			int task = -1;
+			if (PopOrSteal (0, task))
+			{
+				Execute (0, task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock (sleepMutex);
+			wake.wait (lock, [this] { return remainingTasks == 0 || queuedTasks > 0; });
+		}
+
+		graph = nullptr;
+		frameRunSeconds += std::chrono::duration<double> (Clock::now () - start).count ();
+	}
+
+	void Scheduler::ParallelFor (int count, const std::function<void (int)>& job)
+	{
+		TaskGraph taskGraph;
+		taskGraph.AddParallelFor (count, job);
+		Run (taskGraph);
+	}
+
+	void Scheduler::EndFrame ()
+	{
+		if (frameRunSeconds <= 0.0)
+		{
+			return;
+		}
+
+		lastFrameStats.resize (workers.size ());
+		for (int i = 0; i < (int)workers.size (); i++)
+		{
+			Worker& worker = *workers[i];
+			WorkerStats& stats = lastFrameStats[i];
+			stats.tasksRun = worker.tasksRun.exchange (0);
+			stats.steals = worker.steals.exchange (0);
+			stats.busySeconds = (double)worker.busyMicroseconds.exchange (0) / 1e6;
+			stats.idleSeconds = frameRunSeconds > stats.busySeconds ? frameRunSeconds - stats.busySeconds : 0.0;
+		}
+		frameRunSeconds = 0.0;
+	}
+
+	void Scheduler::WorkerLoop (int workerIndex)
+	{
+		trace::SetThreadName ("Scheduler worker");
+		while (true)
+		{
+			int task = -1;
+			if (PopOrSteal (workerIndex, task))
+			{
+				Execute (workerIndex, task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock (sleepMutex);
+			wake.wait (lock, [this] { return stopping || queuedTasks > 0; });
+			if (stopping)
+			{
+				return;
+			}
+		}
+	}
+
+	void Scheduler::Push (int workerIndex, int task)
+	{
+		{
+			Worker& worker = *workers[workerIndex];
+			std::lock_guard<std::mutex> lock (worker.mutex);
+			worker.queue.push_back (task);
+			queuedTasks++;
+		}
+
+		//Taking the sleep lock makes sure a thread that just found no work is already waiting when it is notified
+		{
+			std::lock_guard<std::mutex> lock (sleepMutex);
+		}
+		wake.notify_one ();
+	}
+
+	bool Scheduler::PopOrSteal (int workerIndex, int& task)
+	{
+		{
+			Worker& worker = *workers[workerIndex];
+			std::lock_guard<std::mutex> lock (worker.mutex);
+			if (!worker.queue.empty ())
+			{
+				task = worker.queue.back ();
+				worker.queue.pop_back ();
+				queuedTasks--;
+				return true;
+			}
+		}
+
+		const int count = (int)workers.size ();
+		for (int offset = 1; offset < count; offset++)
+		{
+			Worker& victim = *workers[(workerIndex + offset) % count];
+			std::lock_guard<std::mutex> lock (victim.mutex);
+			if (!victim.queue.empty ())
+			{
+				task = victim.queue.front ();
+				victim.queue.pop_front ();
+				queuedTasks--;
+				workers[workerIndex]->steals++;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Scheduler::Execute (int workerIndex, int task)
+	{
+		Worker& worker = *workers[workerIndex];
+		const Clock::time_point start = Clock::now ();
+
+		graph->Execute (task);
+
+		worker.tasksRun++;
+		worker.busyMicroseconds += std::chrono::duration_cast<std::chrono::microseconds> (Clock::now () - start).count ();
+
+		for (int dependent : graph->tasks[task].dependents)
+		{
+			if (pendingDependencies[dependent].fetch_sub (1) == 1)
+			{
+				Push (workerIndex, dependent);
+			}
+		}
+
+		//The last task wakes up the thread waiting in Run
+		if (remainingTasks.fetch_sub (1) == 1)
+		{
+			{
+				std::lock_guard<std::mutex> lock (sleepMutex);
+			}
+			wake.notify_all ();
+		}
+	}
+}
@@ -66,14 +66,57 @@ namespace sim {
 
 	}
 
+	void Sheep::FindPath (const Point& targetTile)
+	{
+		//Off-screen sheep walk straight at their target, nobody sees them cut corners. They stop short of the first wall on the way, so they never end up inside one
+		if (detail == CoarseDetail)
+		{
+			path.assign (1, world->LastWalkableOnLine (world->position_to_tile_coord (m_position), targetTile));
+			return;
+		}
+		pathStats.Add (world->AStarPathFinding (world->position_to_tile_coord (m_position), targetTile, path, {World::PathAgent::SheepAgent, id, currentState}));
+	}
+
+	void Sheep::SetDetail (Detail newDetail)
+	{
+		if (newDetail == detail)
+		{
+			return;
+		}
+
+		//Coming into view, the straight line path is replaced by a real one on this tick's sense
+		if (newDetail == FullDetail)
+		{
+			//A wall painted over a coarse sheep leaves it where A* can't start from, so it steps onto the closest walkable tile first
+			const Point tile = world->position_to_tile_coord (m_position);
+			if (!world->is_walkable (tile))
+			{
+				const Point walkable = world->NearestWalkableTile (tile);
+				if (walkable.x >= 0)
+				{
+					const Vector2 corner = world->tile_coord_to_position (walkable);
+					m_position = {corner.x + world->m_tile_size.x / 2.f, corner.y + world->m_tile_size.y / 2.f};
+				}
+			}
+			path.clear ();
+			senseDue = true;
+		}
+		detail = newDetail;
+	}
+
+	float Sheep::SenseInterval () const
+	{
+		return detail == CoarseDetail ? world->m_config.sheepSenseInterval * COARSE_SENSE_SCALE : world->m_config.sheepSenseInterval;
+	}
+
+	//note: Called by the world when the EatGrassAt intent of this sheep won, the grass itself has already been eaten
 	void Sheep::EatGrass () {
-		world->EatGrass (m_position);
 		set_sprite_source (EATING_SOURCE);
 		amountGrassEaten++;
 		timeBetweenEating = 0.0f;
-		RegenerateHealth (HEALTH_REGENERATION);
+		RegenerateHealth (world->m_config.sheepHealthRegeneration);
 
-		if (amountGrassEaten >= AMOUNT_GRASS_SATIATED)
+		if (amountGrassEaten >= world->m_config.sheepAmountGrassSatiated)
 		{
 			canReproduce = true;
 			timeSatiated = 0.f;
@@ -82,7 +125,7 @@ namespace sim {
 	}
 
 	void Sheep::Defecate () {
-		world->Defecate (m_position);
+		AddIntent (Intent::DefecateAt, -1, m_position);
 		set_sprite_source (NORMAL_SOURCE);
 		amountGrassEaten = 0.f;
 		timeBetweenEating = 0.f;
@@ -103,7 +146,7 @@ namespace sim {
 
 	bool Sheep::CanSheepEat () const
 	{
-		if (timeBetweenEating >= DELAY_EATING)
+		if (timeBetweenEating >= world->m_config.sheepDelayEating)
 		{
 			return true;
 		}
@@ -127,7 +170,7 @@ namespace sim {
 		}
 	}
 
-	void Sheep::GoTowardsMate (Sheep& sheepMate)
+	void Sheep::GoTowardsMate (const View& sheepMate)
 	{
 		set_sprite_source (REPRODUCTION_SOURCE);
 		velocity = RUNNING_SPEED;
@@ -136,14 +179,22 @@ namespace sim {
 
 	void Sheep::Reproduce () {
 
-		world->ResetSheepMate (world->m_sheep[sheepToMate]);
+		AddIntent (Intent::Unpair, sheepToMate);
 		canReproduce = false;
 		set_sprite_source (SATIATED_SOURCE);
 		randomTargetTile = {-1, -1};
 		currentState = Satiated;
 		sheepToMate = -1;
 		velocity = WALKING_SPEED;
-		world->SpawnSheep (m_position);
+		AddIntent (Intent::SpawnLamb, -1, m_position);
+	}
+
+	//Called by the world when the mate this sheep went for was claimed by another sheep first
+	void Sheep::CancelMating ()
+	{
+		sheepToMate = -1;
+		velocity = WALKING_SPEED;
+		randomTargetTile = {-1, -1};
 	}
 
 	void Sheep::RunAway ()
@@ -155,27 +206,22 @@ namespace sim {
 		//Making sure if the sheep has a mate, that the other sheep does not get stuck mating
 		if (world->isSheepValid (sheepToMate))
 		{
-			world->ResetSheepMate (world->m_sheep[sheepToMate]);
+			AddIntent (Intent::Unpair, sheepToMate);
 		}
 
 		TraverseUsingPath (path);
 	}
 
 
+	//note: Called by the world when the KillSheep command is played back, the world also resets the mate so it does not get stuck in mating
 	void Sheep::KillSheep () {
 		isAlive = false;
 		age = 0.f;
-
-		//Making sure if the sheep has a mate, that the other sheep does not get stuck in mating
-		if (world->isSheepValid (sheepToMate))
-		{
-			world->ResetSheepMate (world->m_sheep[sheepToMate]);
-		}
 	}
 
 	void Sheep::Initiate (const Vector2& position)
 	{
-		const float radius = 20.0f;
+		const float radius = RADIUS;
 		const float target_distance = 70.0f;
 		const Rectangle source = NORMAL_SOURCE;
 		const Vector2 origin = Vector2{source.width, source.height} *0.5f;
@@ -191,11 +237,8 @@ namespace sim {
 		velocity = WALKING_SPEED;
 		sourceBeforeHunted = source;
 
-		senseTimer.timePassed = 0.f;
-		thinkTimer.timePassed = 0.f;
-
-		senseTimer.maxTime = .25f;
-		thinkTimer.maxTime = .5f;
+		senseDue = false;
+		thinkDue = false;
 
 		set_position (position);
 		set_radius (radius);
@@ -203,6 +246,44 @@ namespace sim {
 		set_sprite_source (source);
 	}
 
+	void Sheep::AddIntent (Intent::Type type, int sheep, const Vector2& position)
+	{
+		intents.push_back ({type, sheep, position});
+	}
+
+	void Sheep::OnPerceptionEvent (const Perception::Event& event)
+	{
+		switch (event.type)
+		{
+			case Perception::Event::SheepLeftHuntingRange:
+			{
+				//The wolf hunting this sheep lost track of it
+				if (isBeingHunted && event.source == hunter)
+				{
+					isBeingHunted = false;
+					set_sprite_source (sourceBeforeHunted);
+				}
+				break;
+			}
+			case Perception::Event::GrassReached:
+			{
+				//Thinking right away, instead of walking over the grass until the next think
+				if (currentState == Hungry)
+				{
+					thinkDue = true;
+				}
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	Sheep::View Sheep::GetView () const
+	{
+		return {m_position, m_radius, currentState, isAlive, isMatedWith, sheepToMate};
+	}
+
 	void Sheep::update (float dt)
 	{
 		if (!isAlive)
@@ -212,7 +293,7 @@ namespace sim {
 
 		if (health <= 0.0f)
 		{
-			KillSheep ();
+			AddIntent (Intent::Die);
 			return;
 		}
 
@@ -223,24 +304,27 @@ namespace sim {
 			currentState = Afraid;
 		}
 
-		senseTimer.Update (dt);
-		if (senseTimer.IsDone ())
+		//Sensing and thinking only happen on the ticks the world's wake queue woke this sheep up
+		if (senseDue)
 		{
-			senseTimer.Reset ();
+			senseDue = false;
+			const State before = currentState;
 			Sense (currentState, dt);
+			trace::StateChange ("Sheep sense", id, before, currentState);
 		}
 
-		thinkTimer.Update (dt);
-		if (thinkTimer.IsDone ())
+		if (thinkDue)
 		{
-			thinkTimer.Reset ();
+			thinkDue = false;
+			const State before = currentState;
 			Think (currentState, dt);
+			trace::StateChange ("Sheep think", id, before, currentState);
 		}
 
 		Act (currentState, dt);
 	}
 
-	void Sheep::render (const Texture& texture) const
+	void Sheep::render (SpriteBatch& batch) const
 	{
 		Rectangle src = m_source;
 		float width = src.width;
@@ -252,7 +336,7 @@ namespace sim {
 
 		Rectangle dest = {m_position.x, m_position.y, width, src.height};
 		Vector2 origin = m_origin;
-		DrawTexturePro (texture, src, dest, origin, 0.0f, WHITE);
+		batch.Add (src, dest, origin);
 	}
 	void Sheep::Sense (State& state, float dt)
 	{
@@ -272,13 +356,13 @@ namespace sim {
 				//Generate a new target
 				if (!doesTileExist || hasReachedDestination || !world->has_grass_at (randomTargetTile))
 				{
-					randomTargetTile = world->getRandomTile (m_position, GRASS_HUNTING_RANGE);
+					randomTargetTile = world->getRandomTile (m_position, world->m_config.sheepGrassHuntingRange, random);
 				}
 
 				//Search for path
 				if (world->is_valid_coord (randomTargetTile))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path);
+					FindPath (randomTargetTile);
 				}
 				break;
 			}
@@ -295,13 +379,13 @@ namespace sim {
 
 				if (!doesTileExist || hasReachedDestination)
 				{
-					randomTargetTile = world->getRandomTile (m_position, GRASS_HUNTING_RANGE);
+					randomTargetTile = world->getRandomTile (m_position, world->m_config.sheepGrassHuntingRange, random);
 				}
 
 				//Searching path
 				if (world->is_valid_coord (randomTargetTile))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path);
+					FindPath (randomTargetTile);
 				}
 
 				break;
@@ -319,7 +403,7 @@ namespace sim {
 
 				if (!doesTileExist || hasReachedDestination)
 				{
-					randomTargetTile = world->getRandomTile (m_position, GRASS_HUNTING_RANGE);
+					randomTargetTile = world->getRandomTile (m_position, world->m_config.sheepGrassHuntingRange, random);
 				}
 
 				//Making sure the sheep stays in plays and does not perform unneccesary searching algorithms (since they are rather taxing)
@@ -336,13 +420,13 @@ namespace sim {
 				//Searching for path to sheep to mate
 				if (world->isSheepValid (sheepToMate))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), world->position_to_tile_coord (world->m_sheep[sheepToMate].m_position), path);
+					FindPath (world->position_to_tile_coord (world->m_sheep_views[sheepToMate].position));
 				}
 
 				//In case they have no sheep to mate, search for a path to a random tile
 				if (world->is_valid_coord (randomTargetTile) && sheepToMate == -1)
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path);
+					FindPath (randomTargetTile);
 				}
 				break;
 			}
@@ -357,12 +441,13 @@ namespace sim {
 					hasReachedDestination = Vector2Distance (m_position, world->tile_coord_to_position (randomTargetTile)) < 2 * m_radius;
 				}
 
-				//Generating a random tile specifically away from the wolf, based on where the wolf currently is
+				//Generating a random tile specifically away from the wolf hunting it (or the closest one), based on where that wolf currently is
 				if (!doesTileExist || hasReachedDestination)
 				{
-					Vector2 wolfPosition = world->wolf.m_position;
-					Vector2 min = {m_position.x - FLEEING_RANGE, m_position.y - FLEEING_RANGE};
-					Vector2 max = {m_position.x + FLEEING_RANGE, m_position.y + FLEEING_RANGE};
+					const int wolf = world->isWolfValid (hunter) ? hunter : world->ClosestWolf (m_position, world->m_config.sheepFleeingRange);
+					Vector2 wolfPosition = wolf != -1 ? world->m_wolves[wolf].m_position : m_position;
+					Vector2 min = {m_position.x - world->m_config.sheepFleeingRange, m_position.y - world->m_config.sheepFleeingRange};
+					Vector2 max = {m_position.x + world->m_config.sheepFleeingRange, m_position.y + world->m_config.sheepFleeingRange};
 
 					if (wolfPosition.x < m_position.x)
 					{
@@ -382,8 +467,8 @@ namespace sim {
 						max.y = wolfPosition.y;
 					}
 
-					int x = GetRandomValue (int (min.x), int (max.x));
-					int y = GetRandomValue (int (min.y), int (max.y));
+					int x = random.Range (int (min.x), int (max.x));
+					int y = random.Range (int (min.y), int (max.y));
 
 					//Making sure the tile is in world range
 					randomTargetTile = world->position_to_tile_coord (Vector2Clamp ({(float)x,(float)y}, {0.f,0.f}, world->tile_coord_to_position (world->m_world_size)));
@@ -392,7 +477,7 @@ namespace sim {
 				//Search path to the tile
 				if (world->is_valid_coord (randomTargetTile))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path);
+					FindPath (randomTargetTile);
 				}
 
 				break;
@@ -410,15 +495,17 @@ namespace sim {
 				{
 					Wander ();
 				}
+				//Eating is only committed after the update, since another sheep might eat the same grass this tick
 				if (CanSheepEat () && world->CanGrassBeEaten (m_position))
 				{
-					EatGrass ();
+					AddIntent (Intent::EatGrassAt, -1, m_position);
+					break;
 				}
 
 				if (timeBetweenEating > 0.3f)
 				{
 					set_sprite_source (NORMAL_SOURCE);
-					if (timeBetweenEating >= TIME_BEFORE_DAMAGE)
+					if (timeBetweenEating >= world->m_config.sheepTimeBeforeDamage)
 					{
 						TakeDamage (dt);
 					}
@@ -443,7 +530,7 @@ namespace sim {
 					}
 				}
 
-				if (timeSatiated >= DELAY_DEFECATING)
+				if (timeSatiated >= world->m_config.sheepDelayDefecating)
 				{
 					Defecate ();
 				}
@@ -472,8 +559,8 @@ namespace sim {
 
 				if (world->canSheepCurrentlyMate (sheepToMate))
 				{
-					world->SetSheepAsMate (world->m_sheep[sheepToMate]);
-					GoTowardsMate (world->m_sheep[sheepToMate]);
+					AddIntent (Intent::PairWith, sheepToMate);
+					GoTowardsMate (world->m_sheep_views[sheepToMate]);
 				}
 				else
 				{
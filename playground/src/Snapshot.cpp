@@ -0,0 +1,544 @@
+//Snapshot.cpp
+
+#include "Snapshot.h"
+#include "world.hpp"
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace sim {
+	namespace snapshot {
+		struct Header {
+			uint32_t	magic	= Snapshot::MAGIC;
+			uint32_t	version	= Snapshot::VERSION;
+			int32_t		columns = 0;
+			int32_t		rows	= 0;
+			uint64_t	seed	= 0;
+			uint64_t	tick	= 0;
+			WorldConfig config;
+		};
+
+		struct GrassRecord {
+			float	age					= 0.f;
+			uint8_t state				= 0;
+			uint8_t hasSeedsAvailable	= 0;
+			uint8_t isFertilised		= 0;
+			uint8_t isEdible			= 0;
+		};
+
+		//Zero for tiles without manure, so the layer is mostly one long run
+		struct ManureRecord {
+			float	duration		= 0.f;
+			uint8_t manureExists	= 0;
+			uint8_t hasFertilised	= 0;
+			uint8_t padding[2]		= {};
+		};
+
+		struct Writer {
+			void Raw (const void* data, size_t size)
+			{
+				const uint8_t* begin = (const uint8_t*)data;
+				bytes.insert (bytes.end (), begin, begin + size);
+			}
+
+			template <typename T>
+			void operator() (const T& value)
+			{
+				static_assert (std::is_trivially_copyable_v<T>);
+				Raw (&value, sizeof (T));
+			}
+
+			template <typename T>
+			void operator() (const std::vector<T>& values)
+			{
+				static_assert (std::is_trivially_copyable_v<T>);
+				(*this) ((uint32_t)values.size ());
+				Raw (values.data (), values.size () * sizeof (T));
+			}
+
+			template <typename T>
+			void operator() (const std::vector<std::vector<T>>& values)
+			{
+				(*this) ((uint32_t)values.size ());
+				for (const std::vector<T>& inner : values)
+				{
+					(*this) (inner);
+				}
+			}
+
+			//PackBits: a control byte n < 128 is followed by n + 1 literal bytes, n >= 128 repeats the next byte 257 - n times
+			void Rle (const uint8_t* data, size_t size)
+			{
+				size_t i = 0;
+				while (i < size)
+				{
+					size_t run = 1;
+					while (i + run < size && run < 128 && data[i + run] == data[i])
+					{
+						run++;
+					}
+
+					if (run >= 2)
+					{
+						bytes.push_back ((uint8_t)(257 - run));
+						bytes.push_back (data[i]);
+						i += run;
+						continue;
+					}
+
+					const size_t start = i;
+					while (i < size && i - start < 128 && !(i + 1 < size && data[i + 1] == data[i]))
+					{
+						i++;
+					}
+					bytes.push_back ((uint8_t)(i - start - 1));
+					Raw (data + start, i - start);
+				}
+			}
+
+			std::vector<uint8_t>& bytes;
+		};
+
+		struct Reader {
+			bool Raw (void* data, size_t size)
+			{
+				if (!ok || size > bytes.size () - offset)
+				{
+					ok = false;
+					return false;
+				}
+				std::memcpy (data, bytes.data () + offset, size);
+				offset += size;
+				return true;
+			}
+
+			template <typename T>
+			void operator() (T& value)
+			{
+				static_assert (std::is_trivially_copyable_v<T>);
+				Raw (&value, sizeof (T));
+			}
+
+			template <typename T>
+			void operator() (std::vector<T>& values)
+			{
+				static_assert (std::is_trivially_copyable_v<T>);
+				uint32_t count = 0;
+				(*this) (count);
+				if (!ok || (size_t)count * sizeof (T) > bytes.size () - offset)
+				{
+					ok = false;
+					return;
+				}
+				values.resize (count);
+				Raw (values.data (), count * sizeof (T));
+			}
+
+			template <typename T>
+			void operator() (std::vector<std::vector<T>>& values)
+			{
+				uint32_t count = 0;
+				(*this) (count);
+				if (!ok || count > bytes.size () - offset)
+				{
+					ok = false;
+					return;
+				}
+				values.resize (count);
+				for (std::vector<T>& inner : values)
+				{
+					(*this) (inner);
+				}
+			}
+
+			void Rle (uint8_t* data, size_t size)
+			{
+				size_t i = 0;
+				while (ok && i < size)
+				{
+					uint8_t control = 0;
+					(*this) (control);
+
+					if (control < 128)
+					{
+						const size_t count = (size_t)control + 1;
+						if (count > size - i)
+						{
+							ok = false;
+							return;
+						}
+						Raw (data + i, count);
+						i += count;
+					}
+					else
+					{
+						const size_t count = 257 - (size_t)control;
+						uint8_t value = 0;
+						(*this) (value);
+						if (count > size - i)
+						{
+							ok = false;
+							return;
+						}
+						std::memset (data + i, value, count);
+						i += count;
+					}
+				}
+			}
+
+			const std::vector<uint8_t>& bytes;
+			size_t offset = 0;
+			bool   ok	  = true;
+		};
+
+		//One list of fields per agent, used for both writing (const agents) and reading
+		template <typename Archive, typename SheepType>
+		void TransferSheep (Archive& archive, SheepType& sheep)
+		{
+			archive (sheep.path);
+			archive (sheep.currentState);
+			archive (sheep.detail);
+			archive (sheep.m_position);
+			archive (sheep.targetPosition);
+			archive (sheep.m_direction);
+			archive (sheep.m_origin);
+			archive (sheep.m_source);
+			archive (sheep.sourceBeforeHunted);
+			archive (sheep.randomTargetTile);
+			archive (sheep.m_radius);
+			archive (sheep.age);
+			archive (sheep.health);
+			archive (sheep.amountGrassEaten);
+			archive (sheep.timeSatiated);
+			archive (sheep.timeBetweenEating);
+			archive (sheep.velocity);
+			archive (sheep.m_flip_x);
+			archive (sheep.isAlive);
+			archive (sheep.canReproduce);
+			archive (sheep.isBeingHunted);
+			archive (sheep.isMatedWith);
+			archive (sheep.senseDue);
+			archive (sheep.thinkDue);
+			archive (sheep.sheepToMate);
+			archive (sheep.id);
+			archive (sheep.hunter);
+			archive (sheep.random);
+		}
+
+		template <typename Archive, typename WolfType>
+		void TransferWolf (Archive& archive, WolfType& wolf)
+		{
+			archive (wolf.path);
+			archive (wolf.sheepInRange);
+			archive (wolf.currentState);
+			archive (wolf.m_position);
+			archive (wolf.wolfsDenPosition);
+			archive (wolf.sleepingPosition);
+			archive (wolf.m_direction);
+			archive (wolf.targetPosition);
+			archive (wolf.m_origin);
+			archive (wolf.m_source);
+			archive (wolf.wolfsDenSource);
+			archive (wolf.randomTargetTile);
+			archive (wolf.m_radius);
+			archive (wolf.velocity);
+			archive (wolf.timeBetweenEating);
+			archive (wolf.timeAsleep);
+			archive (wolf.m_flip_x);
+			archive (wolf.hasATarget);
+			archive (wolf.senseDue);
+			archive (wolf.thinkDue);
+			archive (wolf.herderNearby);
+			archive (wolf.herderTooClose);
+			archive (wolf.amountSheepEaten);
+			archive (wolf.sheepToHunt);
+			archive (wolf.herderToAttack);
+			archive (wolf.id);
+			archive (wolf.pack);
+			archive (wolf.actTimer);
+			archive (wolf.random);
+		}
+
+		template <typename Archive, typename HerderType>
+		void TransferHerder (Archive& archive, HerderType& herder)
+		{
+			archive (herder.path);
+			archive (herder.m_position);
+			archive (herder.m_direction);
+			archive (herder.targetPosition);
+			archive (herder.m_origin);
+			archive (herder.targetCoord);
+			archive (herder.m_source);
+			archive (herder.m_radius);
+			archive (herder.velocity);
+			archive (herder.timeSinceAttack);
+			archive (herder.m_flip_x);
+			archive (herder.isAttacked);
+			archive (herder.id);
+		}
+
+		template <typename Archive, typename PerceptionType>
+		void TransferPerception (Archive& archive, PerceptionType& perception)
+		{
+			archive (perception.m_sheep_in_hunting_range);
+			archive (perception.m_sheep_tiles);
+			archive (perception.m_herder_nearby);
+			archive (perception.m_herder_too_close);
+		}
+	}
+
+	void Snapshot::Capture (const World& world)
+	{
+		bytes.clear ();
+		snapshot::Writer writer{bytes};
+
+		snapshot::Header header;
+		header.columns = world.m_world_size.x;
+		header.rows = world.m_world_size.y;
+		header.seed = world.m_seed;
+		header.tick = world.m_tick;
+		header.config = world.m_config;
+		writer (header);
+
+		const size_t tiles = world.m_ground.size ();
+		std::vector<uint8_t> layer (tiles);
+
+		// note: ground, walls and fertilised tiles are both sparse
+		for (size_t i = 0; i < tiles; i++)
+		{
+			layer[i] = world.m_ground[i].is_walkable () ? 1 : 0;
+		}
+		writer.Rle (layer.data (), tiles);
+
+		for (size_t i = 0; i < tiles; i++)
+		{
+			layer[i] = world.m_ground[i].fertilised ? 1 : 0;
+		}
+		writer.Rle (layer.data (), tiles);
+
+		// note: grass, about half the tiles are alive so it is stored as is
+		std::vector<snapshot::GrassRecord> grass (tiles);
+		for (size_t i = 0; i < tiles; i++)
+		{
+			const Grass& tile = world.m_grass[i];
+			grass[i] = {tile.m_age, (uint8_t)tile.currentState, (uint8_t)tile.hasSeedsAvailable, (uint8_t)tile.isFertilised, (uint8_t)tile.isEdible};
+		}
+		writer.Raw (grass.data (), grass.size () * sizeof (snapshot::GrassRecord));
+
+		// note: manure
+		std::vector<snapshot::ManureRecord> manure (tiles);
+		for (size_t i = 0; i < tiles; i++)
+		{
+			const Manure& tile = world.allManure[i];
+			if (tile.manureExists)
+			{
+				manure[i].duration = tile.m_duration;
+				manure[i].manureExists = 1;
+				manure[i].hasFertilised = tile.hasFertilised ? 1 : 0;
+			}
+		}
+		writer.Rle ((const uint8_t*)manure.data (), manure.size () * sizeof (snapshot::ManureRecord));
+
+		// note: agents
+		writer ((uint32_t)world.m_sheep.size ());
+		for (const Sheep& sheep : world.m_sheep)
+		{
+			snapshot::TransferSheep (writer, sheep);
+		}
+		writer ((uint32_t)world.m_wolves.size ());
+		for (const Wolf& wolf : world.m_wolves)
+		{
+			snapshot::TransferWolf (writer, wolf);
+		}
+		writer ((uint32_t)world.m_herders.size ());
+		for (const Herder& herder : world.m_herders)
+		{
+			snapshot::TransferHerder (writer, herder);
+		}
+		writer (world.m_selected_herder);
+
+		// note: scheduling, the order inside a bucket is the order agents wake up in
+		for (const auto& bucket : world.m_wake_queue.buckets)
+		{
+			writer (bucket);
+		}
+		snapshot::TransferPerception (writer, world.m_perception);
+	}
+
+	bool Snapshot::Restore (World& world) const
+	{
+		snapshot::Reader reader{bytes};
+
+		snapshot::Header header;
+		reader (header);
+		if (!reader.ok || header.magic != MAGIC || header.version != VERSION)
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Not a version %u snapshot", VERSION);
+			return false;
+		}
+		if (header.columns != world.m_world_size.x || header.rows != world.m_world_size.y)
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Snapshot is %dx%d tiles, the world is %dx%d", header.columns, header.rows, world.m_world_size.x, world.m_world_size.y);
+			return false;
+		}
+
+		// note: everything is read into temporaries first, so a broken snapshot leaves the world as it was
+		const size_t tiles = world.m_ground.size ();
+		std::vector<uint8_t> walkable (tiles);
+		std::vector<uint8_t> fertilised (tiles);
+		std::vector<snapshot::GrassRecord> grass (tiles);
+		std::vector<snapshot::ManureRecord> manure (tiles);
+
+		reader.Rle (walkable.data (), tiles);
+		reader.Rle (fertilised.data (), tiles);
+		reader.Raw (grass.data (), tiles * sizeof (snapshot::GrassRecord));
+		reader.Rle ((uint8_t*)manure.data (), tiles * sizeof (snapshot::ManureRecord));
+
+		uint32_t sheepCount = 0;
+		reader (sheepCount);
+		if (!reader.ok || sheepCount > bytes.size ())
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Snapshot is truncated");
+			return false;
+		}
+
+		std::vector<Sheep> sheep (sheepCount);
+		for (Sheep& entry : sheep)
+		{
+			snapshot::TransferSheep (reader, entry);
+		}
+
+		uint32_t wolfCount = 0;
+		reader (wolfCount);
+		if (!reader.ok || wolfCount > bytes.size ())
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Snapshot is truncated");
+			return false;
+		}
+		std::vector<Wolf> wolves (wolfCount);
+		for (Wolf& wolf : wolves)
+		{
+			snapshot::TransferWolf (reader, wolf);
+		}
+
+		uint32_t herderCount = 0;
+		reader (herderCount);
+		if (!reader.ok || herderCount > bytes.size ())
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Snapshot is truncated");
+			return false;
+		}
+		std::vector<Herder> herders (herderCount);
+		for (Herder& herder : herders)
+		{
+			snapshot::TransferHerder (reader, herder);
+		}
+
+		int selectedHerder = -1;
+		reader (selectedHerder);
+
+		WakeQueue wakeQueue;
+		for (auto& bucket : wakeQueue.buckets)
+		{
+			reader (bucket);
+		}
+
+		Perception perception;
+		snapshot::TransferPerception (reader, perception);
+
+		if (!reader.ok || reader.offset != bytes.size ())
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Snapshot is truncated or corrupt");
+			return false;
+		}
+
+		// note: apply, every tile may have changed so the cached ground is drawn again as a whole
+		world.invalidate_ground_layer ();
+		world.m_seed = header.seed;
+		world.m_tick = header.tick;
+		world.m_config = header.config;
+
+		for (size_t i = 0; i < tiles; i++)
+		{
+			Ground& ground = world.m_ground[i];
+			ground.set_walkable (walkable[i] != 0);
+			if (fertilised[i])
+			{
+				ground.FertiliseGround ();
+			}
+			else
+			{
+				ground.UnfertiliseGround ();
+			}
+
+			Grass& tile = world.m_grass[i];
+			tile.m_age = grass[i].age;
+			tile.currentState = (Grass::State)grass[i].state;
+			tile.hasSeedsAvailable = grass[i].hasSeedsAvailable != 0;
+			tile.isFertilised = grass[i].isFertilised != 0;
+			tile.isEdible = grass[i].isEdible != 0;
+
+			Manure& pile = world.allManure[i];
+			pile.m_duration = manure[i].duration;
+			pile.manureExists = manure[i].manureExists != 0;
+			pile.hasFertilised = manure[i].hasFertilised != 0;
+		}
+
+		for (Sheep& entry : sheep)
+		{
+			entry.world = &world;
+		}
+		for (Wolf& wolf : wolves)
+		{
+			wolf.world = &world;
+		}
+		for (Herder& herder : herders)
+		{
+			herder.world = &world;
+		}
+		world.m_sheep = std::move (sheep);
+		world.m_wolves = std::move (wolves);
+		world.m_herders = std::move (herders);
+		world.m_selected_herder = selectedHerder;
+		world.m_wake_queue = std::move (wakeQueue);
+		world.m_perception.Reset ();
+		world.m_perception.m_sheep_in_hunting_range = std::move (perception.m_sheep_in_hunting_range);
+		world.m_perception.m_sheep_tiles = std::move (perception.m_sheep_tiles);
+		world.m_perception.m_herder_nearby = std::move (perception.m_herder_nearby);
+		world.m_perception.m_herder_too_close = std::move (perception.m_herder_too_close);
+		world.m_commands.Clear ();
+		return true;
+	}
+
+	bool Snapshot::SaveFile (const char* path) const
+	{
+		std::ofstream file (path, std::ios::binary);
+		if (!file.write ((const char*)bytes.data (), (std::streamsize)bytes.size ()))
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Could not write '%s'", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool Snapshot::LoadFile (const char* path)
+	{
+		std::ifstream file (path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Could not open '%s'", path);
+			return false;
+		}
+
+		const std::streamsize size = file.tellg ();
+		file.seekg (0);
+		bytes.resize ((size_t)size);
+		if (!file.read ((char*)bytes.data (), size))
+		{
+			TraceLog (LOG_WARNING, "SNAPSHOT: Could not read '%s'", path);
+			bytes.clear ();
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,140 @@
+//SpatialGrid.cpp
+
+#include "SpatialGrid.h"
+#include <algorithm>
+
+namespace sim {
+	void SpatialGrid::Begin (const Rectangle& bounds, float cellSize)
+	{
+		m_bounds = bounds;
+		m_cell_size = cellSize;
+		m_cells = {Math::max ((int)std::ceil (bounds.width / cellSize), 1), Math::max ((int)std::ceil (bounds.height / cellSize), 1)};
+		m_pending.clear ();
+	}
+
+	void SpatialGrid::Add (int index, const Vector2& position)
+	{
+		m_pending.push_back ({index, position});
+	}
+
+	void SpatialGrid::Finish ()
+	{
+		const int cellCount = m_cells.x * m_cells.y;
+		m_cell_start.assign (cellCount + 1, 0);
+
+		//Counting the entries per cell, turning the counts into start offsets and then placing every entry
+		for (const Entry& entry : m_pending)
+		{
+			m_cell_start[CellIndex (CellOf (entry.position)) + 1]++;
+		}
+		for (int cell = 0; cell < cellCount; cell++)
+		{
+			m_cell_start[cell + 1] += m_cell_start[cell];
+		}
+
+		m_entries.resize (m_pending.size ());
+		std::vector<int> cursor (m_cell_start.begin (), m_cell_start.end () - 1);
+		for (const Entry& entry : m_pending)
+		{
+			m_entries[cursor[CellIndex (CellOf (entry.position))]++] = entry;
+		}
+	}
+
+	Point SpatialGrid::CellOf (const Vector2& position) const
+	{
+		const int x = (int)std::floor ((position.x - m_bounds.x) / m_cell_size);
+		const int y = (int)std::floor ((position.y - m_bounds.y) / m_cell_size);
+		return {Math::clamp (x, 0, m_cells.x - 1), Math::clamp (y, 0, m_cells.y - 1)};
+	}
+
+	void SpatialGrid::Query (const Vector2& center, float radius, std::vector<int>& result) const
+	{
+		//Nothing was added yet
+		if (m_cell_start.empty ())
+		{
+			return;
+		}
+
+		const size_t first = result.size ();
+		const Point min = CellOf ({center.x - radius, center.y - radius});
+		const Point max = CellOf ({center.x + radius, center.y + radius});
+		const float radiusSquared = radius * radius;
+
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				const int cell = CellIndex ({x, y});
+				for (int i = m_cell_start[cell]; i < m_cell_start[cell + 1]; i++)
+				{
+					if (Vector2DistanceSqr (m_entries[i].position, center) <= radiusSquared)
+					{
+						result.push_back (m_entries[i].index);
+					}
+				}
+			}
+		}
+
+		//Visiting order depends on the cells, sorting keeps the results independent of the cell size
+		std::sort (result.begin () + first, result.end ());
+	}
+
+	void SpatialGrid::QueryRect (const Rectangle& area, std::vector<int>& result) const
+	{
+		if (m_cell_start.empty ())
+		{
+			return;
+		}
+
+		const size_t first = result.size ();
+		const Point min = CellOf ({area.x, area.y});
+		const Point max = CellOf ({area.x + area.width, area.y + area.height});
+
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				const int cell = CellIndex ({x, y});
+				for (int i = m_cell_start[cell]; i < m_cell_start[cell + 1]; i++)
+				{
+					if (CheckCollisionPointRec (m_entries[i].position, area))
+					{
+						result.push_back (m_entries[i].index);
+					}
+				}
+			}
+		}
+		std::sort (result.begin () + first, result.end ());
+	}
+
+	int SpatialGrid::Closest (const Vector2& center, float radius) const
+	{
+		if (m_cell_start.empty ())
+		{
+			return -1;
+		}
+
+		const Point min = CellOf ({center.x - radius, center.y - radius});
+		const Point max = CellOf ({center.x + radius, center.y + radius});
+
+		int closest = -1;
+		float closestDistance = radius * radius;
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				const int cell = CellIndex ({x, y});
+				for (int i = m_cell_start[cell]; i < m_cell_start[cell + 1]; i++)
+				{
+					const float distance = Vector2DistanceSqr (m_entries[i].position, center);
+					if (distance < closestDistance || (distance == closestDistance && (closest == -1 || m_entries[i].index < closest)))
+					{
+						closest = m_entries[i].index;
+						closestDistance = distance;
+					}
+				}
+			}
+		}
+		return closest;
+	}
+}
@@ -0,0 +1,93 @@
+//SpriteBatch.cpp
+
+#include "SpriteBatch.h"
+#include <rlgl.h>
+
+namespace sim {
+	//One quad less than the rlgl buffer holds, so a full run never trips the overflow check in the middle of a quad
+	static constexpr int QUADS_PER_DRAW = RL_DEFAULT_BATCH_BUFFER_ELEMENTS - 1;
+
+	void SpriteBatch::Begin (const Texture2D& batchTexture)
+	{
+		assert (quads.empty () && "SpriteBatch::Begin called twice without End");
+		texture = batchTexture;
+	}
+
+	void SpriteBatch::Add (Rectangle source, const Rectangle& destination, const Vector2& origin, Color tint)
+	{
+		bool flipX = false;
+		bool flipY = false;
+		if (source.width < 0.0f)
+		{
+			flipX = true;
+			source.width = -source.width;
+		}
+		if (source.height < 0.0f)
+		{
+			flipY = true;
+			source.height = -source.height;
+		}
+
+		const float width = (float)texture.width;
+		const float height = (float)texture.height;
+
+		Quad quad;
+		quad.left = destination.x - origin.x;
+		quad.top = destination.y - origin.y;
+		quad.right = quad.left + fabsf (destination.width);
+		quad.bottom = quad.top + fabsf (destination.height);
+		quad.u0 = (flipX ? source.x + source.width : source.x) / width;
+		quad.u1 = (flipX ? source.x : source.x + source.width) / width;
+		quad.v0 = (flipY ? source.y + source.height : source.y) / height;
+		quad.v1 = (flipY ? source.y : source.y + source.height) / height;
+		quad.tint = tint;
+		quads.push_back (quad);
+	}
+
+	void SpriteBatch::End ()
+	{
+		if (quads.empty ())
+		{
+			return;
+		}
+
+		//All quads share the texture and the draw mode, so rlgl keeps appending them to the same draw until its buffer is full
+		rlSetTexture (texture.id);
+		for (size_t first = 0; first < quads.size (); first += QUADS_PER_DRAW)
+		{
+			const size_t count = Math::min (quads.size () - first, (size_t)QUADS_PER_DRAW);
+			rlCheckRenderBatchLimit ((int)count * 4);
+
+			rlBegin (RL_QUADS);
+			rlNormal3f (0.0f, 0.0f, 1.0f);
+			for (size_t i = first; i < first + count; i++)
+			{
+				const Quad& quad = quads[i];
+				rlColor4ub (quad.tint.r, quad.tint.g, quad.tint.b, quad.tint.a);
+
+				rlTexCoord2f (quad.u0, quad.v0);
+				rlVertex2f (quad.left, quad.top);
+				rlTexCoord2f (quad.u0, quad.v1);
+				rlVertex2f (quad.left, quad.bottom);
+				rlTexCoord2f (quad.u1, quad.v1);
+				rlVertex2f (quad.right, quad.bottom);
+				rlTexCoord2f (quad.u1, quad.v0);
+				rlVertex2f (quad.right, quad.top);
+			}
+			rlEnd ();
+
+			stats.drawCalls++;
+		}
+		rlSetTexture (0);
+
+		stats.quads += (int)quads.size ();
+		quads.clear ();
+	}
+
+	SpriteBatch::Stats SpriteBatch::TakeStats ()
+	{
+		const Stats taken = stats;
+		stats = {};
+		return taken;
+	}
+}
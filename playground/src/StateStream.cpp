@@ -0,0 +1,491 @@
+//StateStream.cpp
+
+#include "StateStream.h"
+#include "world.hpp"
+#include <cstring>
+
+namespace sim {
+	namespace statestream {
+		//Tile fields pack the layers into bits, the grass age only down to the sprite it shows
+		enum TileBits : int32_t {
+			WalkableBit		= 1 << 0,
+			FertilisedBit	= 1 << 1,
+			ManureBit		= 1 << 2,
+			GrassShift		= 4, //Sprite index + 1, 0 without grass
+		};
+
+		static constexpr int FRAME_FIELDS	  = 4; //Sheep, wolf and herder count, selected herder
+		static constexpr int FIELDS_PER_AGENT = 8; //x, y, origin x, origin y, flags, three agent specific fields
+		static constexpr float FIXED_POINT	  = 16.f; //Positions are stored in 1/16 pixels
+
+		static constexpr Rectangle SHEEP_SOURCES[] = {Sheep::NORMAL_SOURCE, Sheep::EATING_SOURCE, Sheep::AFRAID_SOURCE, Sheep::SATIATED_SOURCE, Sheep::REPRODUCTION_SOURCE};
+		static constexpr Rectangle WOLF_SOURCES[]  = {Wolf::HUNGRY_SOURCE, Wolf::SATIATED_SOURCE, Wolf::SLEEPING_SOURCE};
+
+		template <size_t N>
+		int32_t SourceIndex (const Rectangle (&sources)[N], const Rectangle& source)
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				if (sources[i].x == source.x && sources[i].y == source.y)
+				{
+					return (int32_t)i;
+				}
+			}
+			return 0;
+		}
+
+		int32_t ToFixed (float value)
+		{
+			return (int32_t)std::lround (value * FIXED_POINT);
+		}
+
+		float FromFixed (int32_t value)
+		{
+			return (float)value / FIXED_POINT;
+		}
+
+		//Flags: alive, flipped, then the sprite index
+		void CaptureAgent (std::vector<int32_t>& fields, const Vector2& position, const Vector2& origin, bool alive, bool flip, int32_t sprite, int32_t extraA = 0, int32_t extraB = 0, int32_t extraC = 0)
+		{
+			fields.push_back (ToFixed (position.x));
+			fields.push_back (ToFixed (position.y));
+			fields.push_back (ToFixed (origin.x));
+			fields.push_back (ToFixed (origin.y));
+			fields.push_back ((alive ? 1 : 0) | (flip ? 2 : 0) | (sprite << 2));
+			fields.push_back (extraA);
+			fields.push_back (extraB);
+			fields.push_back (extraC);
+		}
+
+		void Capture (const World& world, std::vector<int32_t>& fields)
+		{
+			//Tiles first and the growing sheep list last, so new sheep don't shift the fields the previous frame is compared with
+			fields.clear ();
+			fields.push_back ((int32_t)world.m_sheep.size ());
+			fields.push_back ((int32_t)world.m_wolves.size ());
+			fields.push_back ((int32_t)world.m_herders.size ());
+			fields.push_back (world.m_selected_herder);
+
+			const int grassSprites = (int)_countof (Grass::sources);
+			for (size_t i = 0; i < world.m_ground.size (); i++)
+			{
+				const Grass& grass = world.m_grass[i];
+				int32_t tile = 0;
+				tile |= world.m_ground[i].is_walkable () ? WalkableBit : 0;
+				tile |= world.m_ground[i].fertilised ? FertilisedBit : 0;
+				tile |= i < world.allManure.size () && world.allManure[i].manureExists ? ManureBit : 0;
+				if (grass.is_alive ())
+				{
+					tile |= (Math::clamp ((int)(grass.m_age * grassSprites), 0, grassSprites - 1) + 1) << GrassShift;
+				}
+				fields.push_back (tile);
+			}
+
+			for (const Wolf& wolf : world.m_wolves)
+			{
+				CaptureAgent (fields, wolf.m_position, wolf.m_origin, true, wolf.m_flip_x, SourceIndex (WOLF_SOURCES, wolf.m_source), ToFixed (wolf.wolfsDenPosition.x), ToFixed (wolf.wolfsDenPosition.y), wolf.pack);
+			}
+
+			for (const Herder& herder : world.m_herders)
+			{
+				CaptureAgent (fields, herder.m_position, herder.m_origin, true, herder.m_flip_x, herder.isAttacked ? 1 : 0, herder.targetCoord.x, herder.targetCoord.y); //Attacked instead of a sprite
+			}
+
+			for (const Sheep& sheep : world.m_sheep)
+			{
+				CaptureAgent (fields, sheep.m_position, sheep.m_origin, sheep.isAlive, sheep.m_flip_x, SourceIndex (SHEEP_SOURCES, sheep.m_source));
+			}
+		}
+
+		struct AgentFields {
+			Vector2 position;
+			Vector2 origin;
+			bool	alive;
+			bool	flip;
+			int32_t sprite;
+			int32_t extraA;
+			int32_t extraB;
+			int32_t extraC;
+		};
+
+		AgentFields ReadAgent (const int32_t* fields)
+		{
+			AgentFields agent;
+			agent.position = {FromFixed (fields[0]), FromFixed (fields[1])};
+			agent.origin = {FromFixed (fields[2]), FromFixed (fields[3])};
+			agent.alive = (fields[4] & 1) != 0;
+			agent.flip = (fields[4] & 2) != 0;
+			agent.sprite = fields[4] >> 2;
+			agent.extraA = fields[5];
+			agent.extraB = fields[6];
+			agent.extraC = fields[7];
+			return agent;
+		}
+
+		void Apply (const std::vector<int32_t>& fields, World& world)
+		{
+			if (fields.size () < FRAME_FIELDS)
+			{
+				return;
+			}
+
+			const size_t tileCount = world.m_ground.size ();
+			const size_t sheepCount = (size_t)Math::max (fields[0], 0);
+			const size_t wolfCount = (size_t)Math::max (fields[1], 0);
+			const size_t herderCount = (size_t)Math::max (fields[2], 0);
+			if (fields.size () != FRAME_FIELDS + tileCount + (wolfCount + herderCount + sheepCount) * FIELDS_PER_AGENT)
+			{
+				return;
+			}
+			world.m_selected_herder = fields[3];
+
+			const int grassSprites = (int)_countof (Grass::sources);
+			const int32_t* field = fields.data () + FRAME_FIELDS;
+			for (size_t i = 0; i < tileCount; i++, field++)
+			{
+				const int32_t tile = *field;
+				Ground& ground = world.m_ground[i];
+				if (ground.is_walkable () != ((tile & WalkableBit) != 0) || ground.fertilised != ((tile & FertilisedBit) != 0))
+				{
+					world.mark_ground_dirty ((int)i);
+				}
+				ground.set_walkable ((tile & WalkableBit) != 0);
+				if (tile & FertilisedBit)
+				{
+					ground.FertiliseGround ();
+				}
+				else
+				{
+					ground.UnfertiliseGround ();
+				}
+
+				if (i < world.allManure.size ())
+				{
+					world.allManure[i].manureExists = (tile & ManureBit) != 0;
+				}
+
+				//The middle of the sprite's age range, so rendering picks the recorded sprite
+				const int sprite = tile >> GrassShift;
+				world.m_grass[i].set_age (sprite > 0 ? ((float)sprite - 0.5f) / (float)grassSprites : 0.0f);
+			}
+
+			world.m_wolves.resize (wolfCount);
+			for (Wolf& wolf : world.m_wolves)
+			{
+				const AgentFields agent = ReadAgent (field);
+				field += FIELDS_PER_AGENT;
+				wolf.m_position = agent.position;
+				wolf.m_origin = agent.origin;
+				wolf.m_flip_x = agent.flip;
+				wolf.m_source = WOLF_SOURCES[Math::clamp (agent.sprite, 0, (int32_t)_countof (WOLF_SOURCES) - 1)];
+				wolf.wolfsDenSource = Wolf::WOLFS_DEN_SOURCE;
+				wolf.wolfsDenPosition = {FromFixed (agent.extraA), FromFixed (agent.extraB)};
+				wolf.pack = agent.extraC;
+			}
+
+			world.m_herders.resize (herderCount);
+			for (Herder& herder : world.m_herders)
+			{
+				const AgentFields agent = ReadAgent (field);
+				field += FIELDS_PER_AGENT;
+				herder.world = &world;
+				herder.m_position = agent.position;
+				herder.m_origin = agent.origin;
+				herder.m_flip_x = agent.flip;
+				herder.m_source = Herder::NORMAL_SOURCE;
+				herder.m_radius = Herder::RADIUS;
+				herder.isAttacked = agent.sprite != 0;
+				herder.targetCoord = {agent.extraA, agent.extraB};
+			}
+
+			//Sheep that were born after this frame are hidden, not removed, so seeking back and forth doesn't reallocate
+			if (world.m_sheep.size () < sheepCount)
+			{
+				world.m_sheep.resize (sheepCount);
+			}
+			for (size_t i = 0; i < world.m_sheep.size (); i++)
+			{
+				Sheep& sheep = world.m_sheep[i];
+				if (i >= sheepCount)
+				{
+					sheep.isAlive = false;
+					continue;
+				}
+
+				const AgentFields agent = ReadAgent (field);
+				field += FIELDS_PER_AGENT;
+				sheep.m_position = agent.position;
+				sheep.m_origin = agent.origin;
+				sheep.isAlive = agent.alive;
+				sheep.m_flip_x = agent.flip;
+				sheep.m_source = SHEEP_SOURCES[Math::clamp (agent.sprite, 0, (int32_t)_countof (SHEEP_SOURCES) - 1)];
+			}
+		}
+
+		void WriteVarint (std::vector<uint8_t>& bytes, uint32_t value)
+		{
+			while (value >= 0x80)
+			{
+				bytes.push_back ((uint8_t)(value | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back ((uint8_t)value);
+		}
+
+		bool ReadVarint (const uint8_t*& data, const uint8_t* end, uint32_t& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 35; shift += 7)
+			{
+				if (data == end)
+				{
+					return false;
+				}
+				const uint8_t byte = *data++;
+				value |= (uint32_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//Pairs of (unchanged fields to skip, zigzag difference of the next field), ending with a last skip if the frame ends unchanged
+		void Encode (const std::vector<int32_t>& fields, const std::vector<int32_t>& previous, std::vector<uint8_t>& bytes)
+		{
+			bytes.clear ();
+			WriteVarint (bytes, (uint32_t)fields.size ());
+
+			uint32_t skip = 0;
+			for (size_t i = 0; i < fields.size (); i++)
+			{
+				const int32_t before = i < previous.size () ? previous[i] : 0;
+				const uint32_t difference = (uint32_t)fields[i] - (uint32_t)before;
+				if (difference == 0)
+				{
+					skip++;
+					continue;
+				}
+
+				const uint32_t zigzag = (difference << 1) ^ (uint32_t)((int32_t)difference >> 31);
+				WriteVarint (bytes, skip);
+				WriteVarint (bytes, zigzag);
+				skip = 0;
+			}
+			if (skip > 0)
+			{
+				WriteVarint (bytes, skip);
+			}
+		}
+
+		void WriteHeader (std::ofstream& file, const Header& header)
+		{
+			auto write = [&file] (const auto& value) { file.write ((const char*)&value, sizeof (value)); };
+			write (header.magic);
+			write (header.version);
+			write (header.width);
+			write (header.height);
+			write (header.seed);
+			write (header.config);
+			write (header.mapPathLength);
+			write (header.reserved);
+		}
+
+		void ReadHeader (const uint8_t* data, Header& header)
+		{
+			auto read = [&data] (auto& value) {
+				std::memcpy (&value, data, sizeof (value));
+				data += sizeof (value);
+			};
+			read (header.magic);
+			read (header.version);
+			read (header.width);
+			read (header.height);
+			read (header.seed);
+			read (header.config);
+			read (header.mapPathLength);
+			read (header.reserved);
+		}
+
+		bool Decode (const uint8_t* data, size_t size, std::vector<int32_t>& fields)
+		{
+			const uint8_t* end = data + size;
+			uint32_t count = 0;
+			if (!ReadVarint (data, end, count))
+			{
+				return false;
+			}
+			fields.resize (count, 0);
+
+			size_t i = 0;
+			while (i < count)
+			{
+				uint32_t skip = 0;
+				if (!ReadVarint (data, end, skip) || skip > count - i)
+				{
+					return false;
+				}
+				i += skip;
+				if (i == count)
+				{
+					break;
+				}
+
+				uint32_t zigzag = 0;
+				if (!ReadVarint (data, end, zigzag))
+				{
+					return false;
+				}
+				const uint32_t difference = (zigzag >> 1) ^ (0u - (zigzag & 1));
+				fields[i] = (int32_t)((uint32_t)fields[i] + difference);
+				i++;
+			}
+			return true;
+		}
+	}
+
+	bool StateRecorder::Open (const char* path, int width, int height, const World& world, const char* mapPath)
+	{
+		file.open (path, std::ios::binary);
+		if (!file)
+		{
+			TraceLog (LOG_WARNING, "STATESTREAM: Could not create '%s'", path);
+			return false;
+		}
+
+		const std::string map = mapPath ? mapPath : "";
+		statestream::Header header;
+		header.width = width;
+		header.height = height;
+		header.seed = world.m_seed;
+		header.config = world.m_config;
+		header.mapPathLength = (uint32_t)map.size ();
+		statestream::WriteHeader (file, header);
+		file.write (map.data (), (std::streamsize)map.size ());
+
+		previous.clear ();
+		frameCount = 0;
+		totalBytes = statestream::HEADER_BYTES + map.size ();
+		return true;
+	}
+
+	void StateRecorder::Record (const World& world)
+	{
+		if (!file.is_open ())
+		{
+			return;
+		}
+
+		statestream::Capture (world, fields);
+		statestream::FrameHeader frame;
+		frame.tick = world.m_tick;
+		frame.keyframe = frameCount % statestream::KEYFRAME_INTERVAL == 0 ? 1 : 0;
+		if (frame.keyframe)
+		{
+			previous.clear ();
+		}
+		statestream::Encode (fields, previous, bytes);
+		frame.size = (uint32_t)bytes.size ();
+
+		file.write ((const char*)&frame, sizeof (frame));
+		file.write ((const char*)bytes.data (), (std::streamsize)bytes.size ());
+
+		previous.swap (fields);
+		frameCount++;
+		totalBytes += sizeof (frame) + bytes.size ();
+	}
+
+	void StateRecorder::Close ()
+	{
+		if (file.is_open ())
+		{
+			file.close ();
+		}
+	}
+
+	bool StatePlayer::Open (const char* path)
+	{
+		if (!file.Open (path))
+		{
+			TraceLog (LOG_WARNING, "STATESTREAM: Could not open '%s'", path);
+			return false;
+		}
+		if (file.size < statestream::HEADER_BYTES)
+		{
+			TraceLog (LOG_WARNING, "STATESTREAM: '%s' is too small", path);
+			return false;
+		}
+
+		statestream::ReadHeader (file.data, header);
+		if (header.magic != statestream::MAGIC || header.version != statestream::VERSION || header.mapPathLength > file.size - statestream::HEADER_BYTES)
+		{
+			TraceLog (LOG_WARNING, "STATESTREAM: '%s' is not a version %u state stream", path, statestream::VERSION);
+			return false;
+		}
+		mapPath.assign ((const char*)file.data + statestream::HEADER_BYTES, header.mapPathLength);
+
+		//A stream that was cut off (the recording crashed) still plays up to its last whole frame
+		frameOffsets.clear ();
+		size_t offset = statestream::HEADER_BYTES + header.mapPathLength;
+		while (offset + sizeof (statestream::FrameHeader) <= file.size)
+		{
+			statestream::FrameHeader frame;
+			std::memcpy (&frame, file.data + offset, sizeof (frame));
+			if (frame.size > file.size - offset - sizeof (frame))
+			{
+				break;
+			}
+			frameOffsets.push_back (offset);
+			offset += sizeof (frame) + frame.size;
+		}
+
+		current = -1;
+		fields.clear ();
+		return !frameOffsets.empty ();
+	}
+
+	uint64_t StatePlayer::TickAt (int frame) const
+	{
+		statestream::FrameHeader header;
+		std::memcpy (&header, file.data + frameOffsets[frame], sizeof (header));
+		return header.tick;
+	}
+
+	bool StatePlayer::Seek (int frame, World& world)
+	{
+		frame = Math::clamp (frame, 0, FrameCount () - 1);
+		if (frame == current)
+		{
+			return true;
+		}
+
+		//Going back, or further forward than the next keyframe, starts over from the keyframe before the frame
+		int first = current + 1;
+		const int keyframe = frame - frame % statestream::KEYFRAME_INTERVAL;
+		if (current < 0 || frame < current || keyframe > current)
+		{
+			first = keyframe;
+		}
+
+		for (int i = first; i <= frame; i++)
+		{
+			statestream::FrameHeader header;
+			std::memcpy (&header, file.data + frameOffsets[i], sizeof (header));
+			if (header.keyframe)
+			{
+				fields.clear ();
+			}
+			if (!statestream::Decode (file.data + frameOffsets[i] + sizeof (header), header.size, fields))
+			{
+				TraceLog (LOG_WARNING, "STATESTREAM: Frame %d is corrupt", i);
+				current = -1;
+				return false;
+			}
+		}
+
+		current = frame;
+		statestream::Apply (fields, world);
+		return true;
+	}
+}
@@ -0,0 +1,212 @@
+//Trace.cpp
+
+#include "Trace.h"
+#include <raylib.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sim {
+	namespace trace {
+		std::atomic<bool> enabled {false};
+
+		struct Event {
+			const char* name;
+			const char* category;
+			char		phase;
+			int			argCount;
+			int64_t		start; //Nanoseconds since Start
+			int64_t		duration;
+			Arg			args[MAX_ARGS];
+		};
+
+		//Only the owning thread writes to a ring, the lock is for the thread flushing it
+		struct Ring {
+			std::mutex		   mutex;
+			std::vector<Event> events;
+			size_t			   next	 = 0;
+			size_t			   count = 0;
+			int				   thread = 0;
+			const char*		   threadName = nullptr;
+		};
+
+		static std::mutex						  registryMutex;
+		static std::vector<std::unique_ptr<Ring>> rings;
+		static std::string						  tracePath;
+		static Clock::time_point				  epoch;
+
+		//A thread's ring is only allocated once it records its first event
+		static thread_local Ring*		 threadRing = nullptr;
+		static thread_local const char* threadName = nullptr;
+
+		static Ring& ThreadRing ()
+		{
+			if (!threadRing)
+			{
+				std::lock_guard<std::mutex> lock (registryMutex);
+				rings.push_back (std::make_unique<Ring> ());
+				threadRing = rings.back ().get ();
+				threadRing->thread = (int)rings.size ();
+				threadRing->threadName = threadName;
+				threadRing->events.resize (RING_EVENTS);
+			}
+			return *threadRing;
+		}
+
+		static void Record (const char* name, const char* category, char phase, Clock::time_point start, Clock::time_point end, std::initializer_list<Arg> args)
+		{
+			Ring& ring = ThreadRing ();
+			std::lock_guard<std::mutex> lock (ring.mutex);
+
+			//Scopes opened before the trace started (F8 is pressed inside a frame) are cut to begin at its zero point
+			start = std::max (start, epoch);
+			end = std::max (end, start);
+
+			Event& event = ring.events[ring.next];
+			event.name = name;
+			event.category = category;
+			event.phase = phase;
+			event.start = std::chrono::duration_cast<std::chrono::nanoseconds> (start - epoch).count ();
+			event.duration = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ();
+			event.argCount = 0;
+			for (const Arg& arg : args)
+			{
+				if (event.argCount == MAX_ARGS)
+				{
+					break;
+				}
+				event.args[event.argCount++] = arg;
+			}
+
+			ring.next = (ring.next + 1) % RING_EVENTS;
+			ring.count = std::min (ring.count + 1, (size_t)RING_EVENTS);
+		}
+
+		bool Start (const char* path)
+		{
+			std::lock_guard<std::mutex> lock (registryMutex);
+			if (enabled)
+			{
+				return false;
+			}
+			tracePath = path;
+			epoch = Clock::now ();
+			for (auto& ring : rings)
+			{
+				std::lock_guard<std::mutex> ringLock (ring->mutex);
+				ring->next = 0;
+				ring->count = 0;
+			}
+			enabled = true;
+			TraceLog (LOG_INFO, "TRACE: Recording to '%s'", path);
+			return true;
+		}
+
+		void Stop ()
+		{
+			if (!enabled)
+			{
+				return;
+			}
+			enabled = false;
+			Flush ();
+		}
+
+		const char* Path ()
+		{
+			return tracePath.c_str ();
+		}
+
+		void SetThreadName (const char* name)
+		{
+			threadName = name;
+			if (threadRing)
+			{
+				std::lock_guard<std::mutex> lock (threadRing->mutex);
+				threadRing->threadName = name;
+			}
+		}
+
+		void Complete (const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::initializer_list<Arg> args)
+		{
+			if (IsEnabled ())
+			{
+				Record (name, category, 'X', start, end, args);
+			}
+		}
+
+		void Instant (const char* name, const char* category, std::initializer_list<Arg> args)
+		{
+			if (IsEnabled ())
+			{
+				const Clock::time_point now = Clock::now ();
+				Record (name, category, 'i', now, now, args);
+			}
+		}
+
+		bool Flush ()
+		{
+			std::lock_guard<std::mutex> lock (registryMutex);
+			std::ofstream file (tracePath);
+			if (!file)
+			{
+				TraceLog (LOG_ERROR, "TRACE: Could not write '%s'", tracePath.c_str ());
+				return false;
+			}
+
+			//Timestamps are in microseconds, the fraction keeps the nanoseconds
+			char number[32];
+			auto microseconds = [&number] (int64_t nanoseconds) {
+				const long long magnitude = std::llabs ((long long)nanoseconds);
+				std::snprintf (number, sizeof (number), "%s%lld.%03lld", nanoseconds < 0 ? "-" : "", magnitude / 1000, magnitude % 1000);
+				return number;
+			};
+
+			size_t written = 0;
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			for (auto& ring : rings)
+			{
+				std::lock_guard<std::mutex> ringLock (ring->mutex);
+				if (ring->threadName)
+				{
+					file << (written++ ? ",\n" : "") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread << ",\"args\":{\"name\":\"" << ring->threadName << "\"}}";
+				}
+
+				const size_t first = (ring->next + RING_EVENTS - ring->count) % RING_EVENTS;
+				for (size_t i = 0; i < ring->count; i++)
+				{
+					const Event& event = ring->events[(first + i) % RING_EVENTS];
+					file << (written++ ? ",\n" : "") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"" << event.phase << "\"";
+					file << ",\"pid\":1,\"tid\":" << ring->thread << ",\"ts\":" << microseconds (event.start);
+					if (event.phase == 'X')
+					{
+						file << ",\"dur\":" << microseconds (event.duration);
+					}
+					else
+					{
+						file << ",\"s\":\"t\"";
+					}
+					if (event.argCount > 0)
+					{
+						file << ",\"args\":{";
+						for (int arg = 0; arg < event.argCount; arg++)
+						{
+							file << (arg ? "," : "") << '"' << event.args[arg].key << "\":" << event.args[arg].value;
+						}
+						file << '}';
+					}
+					file << '}';
+				}
+			}
+			file << "\n]}\n";
+
+			TraceLog (LOG_INFO, "TRACE: Wrote %zu events to '%s'", written, tracePath.c_str ());
+			return true;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+//WakeQueue.cpp
+
+#include "WakeQueue.h"
+
+namespace sim {
+	void WakeQueue::Clear ()
+	{
+		for (auto& bucket : buckets)
+		{
+			bucket.clear ();
+		}
+	}
+
+	void WakeQueue::Schedule (const WakeUp& wakeUp)
+	{
+		buckets[wakeUp.tick % BUCKET_COUNT].push_back (wakeUp);
+	}
+
+	void WakeQueue::ScheduleStaggered (uint64_t firstTick, int interval, WakeUp wakeUp)
+	{
+		//Spreading the phases of the agents evenly, instead of everything spawned in the same tick waking up in the same tick
+		uint64_t bestTick = firstTick;
+		int bestLoad = Load (firstTick);
+		for (int offset = 1; offset < interval && offset < BUCKET_COUNT; offset++)
+		{
+			const int load = Load (firstTick + offset);
+			if (load < bestLoad)
+			{
+				bestLoad = load;
+				bestTick = firstTick + offset;
+			}
+		}
+
+		wakeUp.tick = bestTick;
+		Schedule (wakeUp);
+	}
+
+	void WakeQueue::PopDue (uint64_t tick, std::vector<WakeUp>& due)
+	{
+		//Wake-ups further than BUCKET_COUNT ticks away share the bucket, those stay in it (in order)
+		std::vector<WakeUp>& bucket = buckets[tick % BUCKET_COUNT];
+		int kept = 0;
+		for (int i = 0; i < (int)bucket.size (); i++)
+		{
+			if (bucket[i].tick <= tick)
+			{
+				due.push_back (bucket[i]);
+			}
+			else
+			{
+				bucket[kept++] = bucket[i];
+			}
+		}
+		bucket.resize (kept);
+	}
+
+	int WakeQueue::Load (uint64_t tick) const
+	{
+		int load = 0;
+		for (const WakeUp& wakeUp : buckets[tick % BUCKET_COUNT])
+		{
+			if (wakeUp.tick == tick)
+			{
+				load++;
+			}
+		}
+		return load;
+	}
+}
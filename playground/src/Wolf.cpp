@@ -2,6 +2,7 @@
 
 #include "Wolf.h"
 #include "world.hpp"
+#include <algorithm>
 
 namespace sim {
 	void Wolf::set_position (const Vector2& position)
@@ -62,17 +63,17 @@ namespace sim {
 
 	}
 
-	void Wolf::Spawn ()
+	void Wolf::Spawn (const Vector2& denPosition, const Vector2& position)
 	{
-		set_position ({192.f, 210.f}); //Set the position of the wolf in front of the den
-		SpawnWolfsDen ({160.f, 160.f});
+		set_position (position); //In front of the den
+		SpawnWolfsDen (denPosition);
 
 		set_radius (19.f);
 		set_sprite_source (HUNGRY_SOURCE);
 		set_sprite_origin (Vector2{m_source.width, m_source.height} *0.5f);
 
 		sleepingPosition = {wolfsDenPosition.x + m_source.width , (wolfsDenPosition.y + wolfsDenSource.height / 2.f) + 0.5f * m_source.height};
-		timeBetweenEating = DELAY_BETWEEN_EATING;
+		timeBetweenEating = world->m_config.wolfDelayBetweenEating;
 		amountSheepEaten = 0;
 		velocity = WALKING_SPEED;
 		timeAsleep = 0.f;
@@ -80,11 +81,13 @@ namespace sim {
 		hasATarget = false;
 		randomTargetTile = {-1, -1};
 
-		senseTimer.timePassed = 0.f;
-		thinkTimer.timePassed = 0.f;
+		senseDue = false;
+		thinkDue = false;
 
-		senseTimer.maxTime = .5f;
-		thinkTimer.maxTime = .25f;
+		sheepInRange.clear ();
+		herderNearby = false;
+		herderTooClose = false;
+		herderToAttack = -1;
 	}
 
 	void Wolf::SpawnWolfsDen (const Vector2& position)
@@ -114,14 +117,14 @@ namespace sim {
 
 	void Wolf::EatSheep ()
 	{
-		world->EatSheep (world->m_sheep[sheepToHunt]);
+		world->EatSheep (sheepToHunt);
 		velocity = WALKING_SPEED;
 		timeBetweenEating = 0.f;
 		amountSheepEaten += 1;
 		hasATarget = false;
 		sheepToHunt = -1;
 
-		if (amountSheepEaten >= AMOUNT_SHEEP_SATIATED)
+		if (amountSheepEaten >= world->m_config.wolfAmountSheepSatiated)
 		{
 			currentState = Satiated;
 		}
@@ -145,7 +148,7 @@ namespace sim {
 
 	void Wolf::AttackHerder ()
 	{
-		world->AttackHerder ();
+		world->AttackHerder (herderToAttack);
 		velocity = WALKING_SPEED;
 		timeBetweenEating = 0.f;
 		hasATarget = false;
@@ -156,25 +159,82 @@ namespace sim {
 
 	void Wolf::update (float dt)
 	{
-		senseTimer.Update (dt);
-		if (senseTimer.IsDone ())
+		//Sensing and thinking only happen on the ticks the world's wake queue woke the wolf up
+		if (senseDue)
 		{
-			senseTimer.Reset ();
+			senseDue = false;
+			const State before = currentState;
 			Sense (currentState, dt);
+			trace::StateChange ("Wolf sense", id, before, currentState);
 		}
 
-		thinkTimer.Update (dt);
-		if (thinkTimer.IsDone ())
+		if (thinkDue)
 		{
-			thinkTimer.Reset ();
+			thinkDue = false;
+			const State before = currentState;
 			Think (currentState, dt);
+			trace::StateChange ("Wolf think", id, before, currentState);
 		}
 
 		Act (currentState, dt);
 
 	}
 
-	void Wolf::render (const Texture& texture) const
+	void Wolf::OnPerceptionEvent (const Perception::Event& event)
+	{
+		switch (event.type)
+		{
+			case Perception::Event::SheepEnteredHuntingRange:
+			{
+				sheepInRange.insert (std::lower_bound (sheepInRange.begin (), sheepInRange.end (), event.subject), event.subject);
+
+				//A hungry wolf without a target looks for it right away
+				if (currentState == Hungry && sheepToHunt == -1 && !herderNearby)
+				{
+					senseDue = true;
+				}
+				break;
+			}
+			case Perception::Event::SheepLeftHuntingRange:
+			{
+				auto sheep = std::lower_bound (sheepInRange.begin (), sheepInRange.end (), event.subject);
+				if (sheep != sheepInRange.end () && *sheep == event.subject)
+				{
+					sheepInRange.erase (sheep);
+				}
+				break;
+			}
+			case Perception::Event::HerderEnteredNearby:
+			{
+				herderNearby = true;
+				senseDue = true;
+				thinkDue = true;
+				break;
+			}
+			case Perception::Event::HerderLeftNearby:
+			{
+				herderNearby = false;
+				break;
+			}
+			case Perception::Event::HerderEnteredTooClose:
+			{
+				herderTooClose = true;
+				herderToAttack = event.source;
+				thinkDue = true;
+				break;
+			}
+			case Perception::Event::HerderLeftTooClose:
+			{
+				herderTooClose = false;
+				herderToAttack = -1;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	void Wolf::render (SpriteBatch& batch) const
 	{
 		Rectangle src = m_source;
 		float width = src.width;
@@ -186,16 +246,16 @@ namespace sim {
 
 		Rectangle dest = {m_position.x, m_position.y, width, src.height};
 		Vector2 origin = m_origin;
-		DrawTexturePro (texture, src, dest, origin, 0.0f, WHITE);
+		batch.Add (src, dest, origin);
 	}
 
-	void Wolf::RenderWolfsDen (const Texture& texture) const
+	void Wolf::RenderWolfsDen (SpriteBatch& batch) const
 	{
 		Rectangle src = wolfsDenSource;
 
 		Rectangle dest = {wolfsDenPosition.x, wolfsDenPosition.y, src.width, src.height};
 		Vector2 origin = {-9.f,0.f}; //Adjust origin so the base of the wolfs den lines up with the tiles, instead of it being based on the roof
-		DrawTexturePro (texture, src, dest, origin, 0.0f, WHITE);
+		batch.Add (src, dest, origin);
 	}
 
 	void Wolf::Sense (State& state, float dt)
@@ -215,17 +275,17 @@ namespace sim {
 
 				if (!doesTileExist || hasReachedDestination)
 				{
-					randomTargetTile = world->getRandomTile (m_position, MAX_WANDERING_DISTANCE);
+					randomTargetTile = world->getRandomTile (m_position, world->m_config.wolfMaxWanderingDistance, random);
 				}
 
 
 				//Generating a random tile away from the herder
-				if (world->IsHerderNearby (world->position_to_tile_coord (m_position)))
+				if (herderNearby)
 				{
 					sheepToHunt = -1;
-					Vector2 wolfPosition = world->wolf.m_position;
-					Vector2 min = {m_position.x - MAX_HUNTING_DISTANCE, m_position.y - MAX_HUNTING_DISTANCE};
-					Vector2 max = {m_position.x + MAX_HUNTING_DISTANCE, m_position.y + MAX_HUNTING_DISTANCE};
+					Vector2 wolfPosition = m_position;
+					Vector2 min = {m_position.x - world->m_config.wolfMaxHuntingDistance, m_position.y - world->m_config.wolfMaxHuntingDistance};
+					Vector2 max = {m_position.x + world->m_config.wolfMaxHuntingDistance, m_position.y + world->m_config.wolfMaxHuntingDistance};
 
 					if (wolfPosition.x < m_position.x)
 					{
@@ -246,35 +306,35 @@ namespace sim {
 					}
 
 
-					int x = GetRandomValue (int (min.x), int (max.x));
-					int y = GetRandomValue (int (min.y), int (max.y));
+					int x = random.Range (int (min.x), int (max.x));
+					int y = random.Range (int (min.y), int (max.y));
 
 					//Ensuring the target tile is in the world space
 					randomTargetTile = world->position_to_tile_coord (Vector2Clamp ({(float)x,(float)y}, {0.f,0.f}, world->tile_coord_to_position (world->m_world_size)));
 				}
 
 				//When the herder is too close, actually move towards the herder
-				if (world->IsHerderTooClose (world->position_to_tile_coord (m_position)))
+				if (herderTooClose && world->isHerderValid (herderToAttack))
 				{
-					randomTargetTile = world->position_to_tile_coord (world->herder.m_position);
+					randomTargetTile = world->position_to_tile_coord (world->m_herders[herderToAttack].m_position);
 				}
 
 				//Making sure the wolf only hunts when the herder is away and doesn't yet have a target
-				if (sheepToHunt == -1 && !world->IsHerderNearby (world->position_to_tile_coord (m_position)))
+				if (sheepToHunt == -1 && !herderNearby)
 				{
-					sheepToHunt = world->ReturnSheepToEat ();
+					sheepToHunt = world->ReturnSheepToEat (*this);
 				};
 
 				//Search a path if the sheep exists
 				if (world->isSheepValid (sheepToHunt))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), world->position_to_tile_coord (world->m_sheep[sheepToHunt].m_position), path);
+					pathStats.Add (world->AStarPathFinding (world->position_to_tile_coord (m_position), world->position_to_tile_coord (world->m_sheep[sheepToHunt].m_position), path, {World::PathAgent::WolfAgent, id, currentState}));
 				}
 
 				//If the sheep does not exist, searching a path to a random tile
 				if (sheepToHunt == -1 && world->is_valid_coord (randomTargetTile))
 				{
-					world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path);
+					pathStats.Add (world->AStarPathFinding (world->position_to_tile_coord (m_position), randomTargetTile, path, {World::PathAgent::WolfAgent, id, currentState}));
 				}
 
 				break;
@@ -283,7 +343,7 @@ namespace sim {
 			case Satiated:
 			{
 				//Search path to den
-				world->AStarPathFinding (world->position_to_tile_coord (m_position), world->position_to_tile_coord (sleepingPosition), path);
+				pathStats.Add (world->AStarPathFinding (world->position_to_tile_coord (m_position), world->position_to_tile_coord (sleepingPosition), path, {World::PathAgent::WolfAgent, id, currentState}));
 				break;
 			}
 
@@ -302,7 +362,7 @@ namespace sim {
 			case Hungry:
 			{
 				//Ensuring the wolf runs instead of walks when the herder is nearby
-				if (world->IsHerderNearby (world->position_to_tile_coord (m_position)))
+				if (herderNearby)
 				{
 					velocity = RUNNING_SPEED;
 				}
@@ -312,7 +372,7 @@ namespace sim {
 				}
 
 				//If the herder is too close attack it
-				if (world->IsHerderTooClose(world->position_to_tile_coord (m_position)))
+				if (herderTooClose)
 				{
 					AttackHerder ();
 					break;
@@ -325,14 +385,14 @@ namespace sim {
 				}
 
 				//Ensuring the wolf does not go hunt sheep when having eaten recently
-				if (timeBetweenEating < DELAY_BETWEEN_EATING)
+				if (timeBetweenEating < world->m_config.wolfDelayBetweenEating)
 				{
 					break;
 				}
 
 				HuntSheep (sheepToHunt);
 
-				if (world->CanSheepBeEaten (sheepToHunt))
+				if (world->CanSheepBeEaten (id, sheepToHunt))
 				{
 					EatSheep ();
 				}
@@ -353,7 +413,7 @@ namespace sim {
 			case Asleep:
 			{
 				set_sprite_source (SLEEPING_SOURCE);
-				if (timeAsleep >= SLEEP_TIME)
+				if (timeAsleep >= world->m_config.wolfSleepTime)
 				{
 					timeAsleep = 0.f;
 					amountSheepEaten = 0;
@@ -0,0 +1,73 @@
+//WorldConfig.cpp
+
+#include "WorldConfig.h"
+
+namespace sim {
+	const WorldConfig::Parameter WorldConfig::PARAMETERS[] = {
+		{"world.start_amount_sheep",		nullptr, &WorldConfig::startAmountSheep},
+		{"world.start_amount_wolves",		nullptr, &WorldConfig::startAmountWolves},
+		{"world.start_amount_herders",		nullptr, &WorldConfig::startAmountHerders},
+		{"world.columns",					nullptr, &WorldConfig::worldColumns},
+		{"world.rows",						nullptr, &WorldConfig::worldRows},
+
+		{"sheep.amount_grass_satiated",		&WorldConfig::sheepAmountGrassSatiated},
+		{"sheep.delay_defecating",			&WorldConfig::sheepDelayDefecating},
+		{"sheep.delay_eating",				&WorldConfig::sheepDelayEating},
+		{"sheep.time_before_damage",		&WorldConfig::sheepTimeBeforeDamage},
+		{"sheep.health_regeneration",		&WorldConfig::sheepHealthRegeneration},
+		{"sheep.sense_interval",			&WorldConfig::sheepSenseInterval},
+		{"sheep.think_interval",			&WorldConfig::sheepThinkInterval},
+		{"sheep.grass_hunting_range",		&WorldConfig::sheepGrassHuntingRange},
+		{"sheep.fleeing_range",				&WorldConfig::sheepFleeingRange},
+
+		{"wolf.max_hunting_distance",		&WorldConfig::wolfMaxHuntingDistance},
+		{"wolf.max_wandering_distance",		&WorldConfig::wolfMaxWanderingDistance},
+		{"wolf.sleep_time",					&WorldConfig::wolfSleepTime},
+		{"wolf.delay_between_eating",		&WorldConfig::wolfDelayBetweenEating},
+		{"wolf.sense_interval",				&WorldConfig::wolfSenseInterval},
+		{"wolf.think_interval",				&WorldConfig::wolfThinkInterval},
+		{"wolf.amount_sheep_satiated",		nullptr, &WorldConfig::wolfAmountSheepSatiated},
+		{"wolf.pack_size",					nullptr, &WorldConfig::wolfPackSize},
+
+		{"grass.normal_grow_speed",			&WorldConfig::grassNormalGrowSpeed},
+		{"grass.fertilised_grow_speed",		&WorldConfig::grassFertilisedGrowSpeed},
+
+		{"manure.max_duration",				&WorldConfig::manureMaxDuration},
+	};
+
+	const int WorldConfig::PARAMETER_COUNT = int (sizeof (PARAMETERS) / sizeof (PARAMETERS[0]));
+
+	bool WorldConfig::Set (std::string_view key, float value)
+	{
+		for (const Parameter& parameter : PARAMETERS)
+		{
+			if (key != parameter.key)
+			{
+				continue;
+			}
+
+			if (parameter.floatValue)
+			{
+				this->*parameter.floatValue = value;
+			}
+			else
+			{
+				this->*parameter.intValue = int (value);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	float WorldConfig::Get (std::string_view key) const
+	{
+		for (const Parameter& parameter : PARAMETERS)
+		{
+			if (key == parameter.key)
+			{
+				return parameter.floatValue ? this->*parameter.floatValue : float (this->*parameter.intValue);
+			}
+		}
+		return 0.f;
+	}
+}
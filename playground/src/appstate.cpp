@@ -1,6 +1,10 @@
 // appstate.cpp
 
 #include "appstate.hpp"
+#include "Snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 
 namespace sim
 {
@@ -10,21 +14,143 @@ namespace sim
    {
    }
 
-   bool AppState::init(int width, int height)
+   bool AppState::record(const char* path)
+   {
+      m_log_mode = LogMode::RECORD;
+      m_log_path = path;
+      m_editor.m_recording = true;
+      return true;
+   }
+
+   bool AppState::replay(const char* path)
+   {
+      if (!m_input_log.LoadFile(path)) {
+         return false;
+      }
+      m_log_mode = LogMode::REPLAY;
+      m_log_path = path;
+      m_replay_cursor = 0;
+      m_editor.m_locked = true;
+      return true;
+   }
+
+   bool AppState::record_stream(const char* path)
+   {
+      m_stream_path = path;
+      return true;
+   }
+
+   bool AppState::play_stream(const char* path)
+   {
+      if (!m_state_player.Open(path)) {
+         return false;
+      }
+      m_mode = Mode::PLAYBACK;
+      m_stream_path = path;
+      m_playback_frame = 0.0;
+      return true;
+   }
+
+   bool AppState::world_size(const char* size)
+   {
+      int columns = 0;
+      int rows = 0;
+      if (std::sscanf(size, "%dx%d", &columns, &rows) != 2 || columns <= 0 || rows <= 0) {
+         TraceLog(LOG_ERROR, "SIM: World size '%s' is not <columns>x<rows>", size);
+         return false;
+      }
+      m_config.worldColumns = columns;
+      m_config.worldRows = rows;
+      return true;
+   }
+
+   bool AppState::init(int width, int height, uint64_t seed, const char* map_path)
    {
       m_texture = LoadTexture("data/CustomTiles.png");
       cursorTexture = LoadTexture("data/Cursor.png");
       
-      m_world.init(width, height, &m_texture, &cursorTexture);
+      // note: the simulation thread runs tasks too and the main thread renders, so two worker threads less than there are cores
+      const int cores = (int)std::thread::hardware_concurrency();
+      m_scheduler.Start(cores > 2 ? cores - 2 : 0);
+
+      WorldConfig config = m_config;
+      if (m_log_mode == LogMode::REPLAY) {
+         width = m_input_log.width;
+         height = m_input_log.height;
+         seed = m_input_log.seed;
+         config = m_input_log.config;
+         map_path = m_input_log.mapPath.empty() ? nullptr : m_input_log.mapPath.c_str();
+      }
+      else if (m_mode == Mode::PLAYBACK) {
+         // note: the world only has to have the recorded size, every frame overwrites what it shows
+         width = m_state_player.header.width;
+         height = m_state_player.header.height;
+         seed = m_state_player.header.seed;
+         config = m_state_player.header.config;
+         map_path = m_state_player.mapPath.empty() ? nullptr : m_state_player.mapPath.c_str();
+      }
+
+      // note: the worlds copy the map's tiles, so the mapping is only needed during init. The display world starts out the same and from then on follows the snapshots
+      MapFile map;
+      const bool has_map = map_path && map.Open(map_path);
+      m_world.init(width, height, nullptr, nullptr, seed, &m_scheduler, config, has_map ? &map : nullptr);
+      m_view_world.init(width, height, &m_texture, &cursorTexture, seed, nullptr, config, has_map ? &map : nullptr);
       m_editor.init();
+      m_editor.m_camera = &m_camera;
+      m_editor.m_commands = &m_commands;
+
+      // note: a world that fits the window starts out exactly as without a camera, a bigger one starts at its centre
+      const Rectangle &bounds = m_view_world.m_world_bounds;
+      const bool fits = bounds.width <= float(width) && bounds.height <= float(height);
+      m_camera = {};
+      m_camera.offset = { float(width) / 2.0f, float(height) / 2.0f };
+      m_camera.target = fits ? m_camera.offset : Vector2{ bounds.x + bounds.width / 2.0f, bounds.y + bounds.height / 2.0f };
+      m_camera.zoom = 1.0f;
 
+      if (m_log_mode == LogMode::RECORD) {
+         m_input_log.Begin(width, height, seed, config, has_map ? map_path : nullptr);
+      }
+      if (m_mode == Mode::PLAYBACK) {
+         m_state_player.Seek(0, m_view_world);
+         return true;
+      }
+
+      if (!m_stream_path.empty()) {
+         m_state_recorder.Open(m_stream_path.c_str(), width, height, m_world, has_map ? map_path : nullptr);
+      }
+
+      m_sim_mode = m_mode;
+      m_sim_time_scale = m_time_scale;
+      m_sim_stopping = false;
+      m_sim_thread = std::thread([this] { sim_loop(); });
       return true;
    }
 
    void AppState::shut()
    {
+      // note: after this the simulation's state belongs to the main thread again
+      m_sim_stopping = true;
+      if (m_sim_thread.joinable()) {
+         m_sim_thread.join();
+      }
+
+      if (m_log_mode == LogMode::RECORD && m_input_log.SaveFile(m_log_path.c_str())) {
+         TraceLog(LOG_INFO, "INPUTLOG: Recorded %llu ticks, %zu events to '%s'", (unsigned long long)m_world.m_tick, m_input_log.events.size(), m_log_path.c_str());
+      }
+
+      if (m_state_recorder.IsOpen()) {
+         TraceLog(LOG_INFO, "STATESTREAM: Recorded %llu ticks to '%s' (%llu bytes)", (unsigned long long)m_state_recorder.frameCount, m_stream_path.c_str(), (unsigned long long)m_state_recorder.totalBytes);
+         m_state_recorder.Close();
+      }
+
+      if (!m_path_stats_path.empty()) {
+         m_world.m_path_telemetry.WriteCsv(m_path_stats_path.c_str());
+      }
+
       m_editor.shut();
+      m_view_world.shut();
       m_world.shut();
+      m_scheduler.Stop();
       
       UnloadTexture(m_texture);
       m_texture = {};
@@ -32,36 +158,370 @@ namespace sim
 
    bool AppState::update(float dt)
    {
+      // note: the last frame's update and render are both done by now
+      profiler::EndFrame(profiler::Frame);
+      PROFILE_SCOPE(profiler::FrameUpdate);
+
       if (IsKeyReleased(KEY_ESCAPE)) {
          m_running = false;
       }
 
-      if (IsKeyPressed(KEY_F1)) {
+      // note: F8 starts recording a trace, or writes the running one and stops it
+      if (IsKeyPressed(KEY_F8)) {
+         if (trace::IsEnabled()) {
+            trace::Stop();
+         }
+         else {
+            trace::Start(*trace::Path() ? trace::Path() : TRACE_PATH);
+         }
+      }
+
+      if (IsKeyPressed(KEY_F1) && m_mode != Mode::PLAYBACK) {
          if (m_mode == Mode::VIEW) {
             m_mode = Mode::EDIT;
          }
          else if (m_mode == Mode::EDIT) {
             m_mode = Mode::VIEW;
          }
+         m_commands.post({ SimCommand::SET_MODE, (int)m_mode });
       }
 
+      const int time_scale_keys[] = { KEY_ONE, KEY_TWO, KEY_THREE, KEY_FOUR };
+      for (int i = 0; i < (int)_countof(time_scale_keys); i++) {
+         if (IsKeyPressed(time_scale_keys[i])) {
+            m_time_scale = i;
+            m_commands.post({ SimCommand::SET_TIME_SCALE, i });
+         }
+      }
+
+      update_camera(dt);
+
       if (m_mode == Mode::VIEW) {
-         m_world.update(dt);
+         post_world_input();
       }
       else if (m_mode == Mode::EDIT) {
          m_editor.update(dt);
+
+         // note: the heatmap counts live in the simulated world, which is paused while editing
+         std::lock_guard<std::mutex> lock(m_world_mutex);
+         m_editor.update_heatmap();
+      }
+      else if (m_mode == Mode::PLAYBACK) {
+         update_playback(dt);
+      }
+
+      // note: only the newest snapshot is shown, the ones published in between are skipped. Applying it only marks the ground tiles that changed
+      if (m_mode != Mode::PLAYBACK && m_snapshots.Acquire()) {
+         PROFILE_SCOPE(profiler::ApplySnapshot);
+         const RenderSnapshot &snapshot = m_snapshots.Front();
+         statestream::Apply(snapshot.fields, m_view_world);
+         m_editor.m_locked = snapshot.log_mode == (int)LogMode::REPLAY;
+      }
+
+      // note: before drawing starts, the ground chunks are render targets of their own
+      {
+         PROFILE_SCOPE(profiler::PrepareRender);
+         m_view_world.prepare_render();
       }
 
       return m_running;
    }
 
+   void AppState::update_camera(float dt)
+   {
+      // note: the wheel zooms towards the cursor, the middle button drags the view and WASD scrolls it
+      const float wheel = GetMouseWheelMove();
+      if (wheel != 0.0f) {
+         const Vector2 anchor = GetScreenToWorld2D(GetMousePosition(), m_camera);
+         m_camera.zoom = Math::clamp(m_camera.zoom * (1.0f + CAMERA_ZOOM_STEP * wheel), CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+         m_camera.offset = GetMousePosition();
+         m_camera.target = anchor;
+      }
+
+      if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
+         m_camera.target = m_camera.target - GetMouseDelta() / m_camera.zoom;
+      }
+
+      Vector2 scroll{};
+      scroll.x = float(IsKeyDown(KEY_D)) - float(IsKeyDown(KEY_A));
+      scroll.y = float(IsKeyDown(KEY_S)) - float(IsKeyDown(KEY_W));
+      m_camera.target = m_camera.target + scroll * (CAMERA_SCROLL_SPEED * dt / m_camera.zoom);
+
+      // note: the centre of the screen stays over the world, so it can't get lost off to the side
+      const Rectangle &bounds = m_world.m_world_bounds;
+      const Vector2 center = GetScreenToWorld2D({ float(GetScreenWidth()) / 2.0f, float(GetScreenHeight()) / 2.0f }, m_camera);
+      const Vector2 clamped = { Math::clamp(center.x, bounds.x, bounds.x + bounds.width), Math::clamp(center.y, bounds.y, bounds.y + bounds.height) };
+      m_camera.target = m_camera.target + (clamped - center);
+   }
+
+   void AppState::post_world_input()
+   {
+      const Rectangle view = camera_view();
+      if (std::memcmp(&view, &m_posted_view, sizeof(view)) != 0) {
+         m_commands.post({ SimCommand::VIEW, 0, view.x, view.y, view.width, view.height });
+         m_posted_view = view;
+      }
+
+      // note: clicking a herder selects it, holding the button moves the selected herder. Which herder was clicked is up to the simulation
+      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+         const Vector2 target = GetScreenToWorld2D(GetMousePosition(), m_camera);
+         m_commands.post({ SimCommand::HERDER_INPUT, IsMouseButtonPressed(MOUSE_BUTTON_LEFT) ? 1 : 0, target.x, target.y });
+      }
+   }
+
+   void AppState::sim_loop()
+   {
+      trace::SetThreadName("Simulation");
+      using Clock = std::chrono::steady_clock;
+      const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FRAME_SECONDS));
+
+      publish();
+
+      Clock::time_point last = Clock::now();
+      while (!m_sim_stopping) {
+         const Clock::time_point start = Clock::now();
+         const float dt = std::chrono::duration<float>(start - last).count();
+         last = start;
+
+         {
+            std::lock_guard<std::mutex> lock(m_world_mutex);
+            sim_step(dt);
+         }
+         publish();
+         profiler::EndFrame(profiler::Step);
+
+         // note: one step per frame, at max speed the ticks already filled it
+         std::this_thread::sleep_until(start + step);
+      }
+   }
+
+   void AppState::sim_step(float dt)
+   {
+      using Clock = std::chrono::steady_clock;
+      const Clock::time_point start = Clock::now();
+
+      m_commands.take(m_applied_commands);
+      for (const SimCommand &command : m_applied_commands) {
+         apply_command(command);
+      }
+
+      if (m_sim_mode != Mode::VIEW) {
+         m_scheduler.EndFrame();
+         return;
+      }
+
+      // note: the step has the whole frame to itself, rendering happens on the main thread
+      const int time_scale = TIME_SCALES[m_sim_time_scale];
+      m_tick_accumulator += double(dt) * time_scale;
+
+      int ticks = 0;
+      while (time_scale == 0 || m_tick_accumulator >= World::TICK_SECONDS) {
+         run_tick();
+         m_tick_accumulator -= World::TICK_SECONDS;
+         ticks++;
+
+         if (std::chrono::duration<double>(Clock::now() - start).count() >= FRAME_SECONDS) {
+            break;
+         }
+      }
+
+      const bool budget_hit = time_scale != 0 && m_tick_accumulator >= World::TICK_SECONDS;
+
+      // note: ticks that did not fit are dropped rather than owed, catching up would only slow down the next steps too
+      m_tick_accumulator = Math::clamp(m_tick_accumulator, 0.0, double(World::TICK_SECONDS));
+
+      m_ticks_counted += ticks;
+      m_counted_seconds += dt;
+      m_budget_hit |= budget_hit;
+
+      double pass_seconds[World::PASS_COUNT];
+      m_world.TakePassCosts(pass_seconds);
+      for (int pass = 0; pass < World::PASS_COUNT; pass++) {
+         m_pass_seconds[pass] += pass_seconds[pass];
+      }
+
+      if (m_counted_seconds >= 1.0) {
+         m_ticks_per_second = m_ticks_counted / m_counted_seconds;
+         for (int pass = 0; pass < World::PASS_COUNT; pass++) {
+            m_tick_costs[pass] = m_ticks_counted > 0 ? m_pass_seconds[pass] * 1000.0 / m_ticks_counted : 0.0;
+            m_pass_seconds[pass] = 0.0;
+         }
+         m_ticks_counted = 0;
+         m_counted_seconds = 0.0;
+         m_budget_hit = budget_hit;
+      }
+
+      m_scheduler.EndFrame();
+   }
+
+   void AppState::apply_command(const SimCommand& command)
+   {
+      // note: input is recorded on the tick it is applied at. A replay takes the view, herder clicks and edits from the log, live input would change the outcome
+      InputLog::Event event;
+      event.tick = m_world.m_tick;
+      const bool recording = m_log_mode == LogMode::RECORD;
+      const bool replaying = m_log_mode == LogMode::REPLAY;
+
+      switch (command.type) {
+      case SimCommand::SET_MODE:
+         m_sim_mode = (Mode)command.value;
+         if (recording) {
+            event.type = InputLog::Event::ModeSwitch;
+            event.x = (float)command.value;
+            m_input_log.Record(event);
+         }
+         break;
+      case SimCommand::SET_TIME_SCALE:
+         m_sim_time_scale = command.value;
+         m_tick_accumulator = 0.0;
+         break;
+      case SimCommand::VIEW:
+      {
+         if (replaying) {
+            break;
+         }
+         const Rectangle view = { command.x, command.y, command.width, command.height };
+         m_world.set_view(view);
+         if (recording && std::memcmp(&view, &m_recorded_view, sizeof(view)) != 0) {
+            event.type = InputLog::Event::View;
+            event.x = view.x;
+            event.y = view.y;
+            event.width = view.width;
+            event.height = view.height;
+            m_input_log.Record(event);
+            m_recorded_view = view;
+         }
+         break;
+      }
+      case SimCommand::HERDER_INPUT:
+      {
+         if (replaying) {
+            break;
+         }
+         const Vector2 target = { command.x, command.y };
+         const int clicked_herder = command.value != 0 ? m_world.HerderAt(target) : -1;
+         if (clicked_herder != -1) {
+            m_world.SelectHerder(clicked_herder);
+            event.type = InputLog::Event::SelectHerder;
+            event.x = (float)clicked_herder;
+         }
+         else {
+            m_world.MoveHerderTo(target);
+            event.type = InputLog::Event::HerderTarget;
+            event.x = target.x;
+            event.y = target.y;
+         }
+         if (recording) {
+            m_input_log.Record(event);
+         }
+         break;
+      }
+      case SimCommand::TILE_ACTIVE:
+      case SimCommand::TILE_INACTIVE:
+      {
+         const bool active = command.type == SimCommand::TILE_ACTIVE;
+         const Point coord = { (int)command.x, (int)command.y };
+         // note: only actual changes are logged, holding the button over a tile would otherwise log it every frame
+         if (replaying || !m_world.is_valid_coord(coord) || !m_world.set_tile_active(coord, active) || !recording) {
+            break;
+         }
+         event.type = active ? InputLog::Event::TileActive : InputLog::Event::TileInactive;
+         event.x = (float)coord.x;
+         event.y = (float)coord.y;
+         m_input_log.Record(event);
+         break;
+      }
+      case SimCommand::SAVE_SNAPSHOT:
+      {
+         Snapshot snapshot;
+         snapshot.Capture(m_world);
+         if (snapshot.SaveFile(Editor::SNAPSHOT_PATH)) {
+            TraceLog(LOG_INFO, "SNAPSHOT: Saved tick %llu to '%s' (%d bytes)", (unsigned long long)m_world.m_tick, Editor::SNAPSHOT_PATH, (int)snapshot.bytes.size());
+         }
+         break;
+      }
+      case SimCommand::LOAD_SNAPSHOT:
+      {
+         Snapshot snapshot;
+         if (m_log_mode == LogMode::NONE && snapshot.LoadFile(Editor::SNAPSHOT_PATH) && snapshot.Restore(m_world)) {
+            TraceLog(LOG_INFO, "SNAPSHOT: Loaded tick %llu from '%s'", (unsigned long long)m_world.m_tick, Editor::SNAPSHOT_PATH);
+         }
+         break;
+      }
+      case SimCommand::EXPORT_MAP:
+         MapFile::Export(m_world, Editor::MAP_PATH);
+         break;
+      }
+   }
+
+   void AppState::publish()
+   {
+      PROFILE_SCOPE(profiler::Publish);
+      RenderSnapshot &snapshot = m_snapshots.Back();
+      snapshot.tick = m_world.m_tick;
+      statestream::Capture(m_world, snapshot.fields);
+
+      std::memcpy(snapshot.detail_counts, m_world.m_detail_counts, sizeof(snapshot.detail_counts));
+      std::memcpy(snapshot.tick_costs, m_tick_costs, sizeof(snapshot.tick_costs));
+      snapshot.ticks_per_second = m_ticks_per_second;
+      snapshot.budget_hit = m_budget_hit;
+      snapshot.worker_stats = m_scheduler.lastFrameStats;
+
+      snapshot.log_mode = (int)m_log_mode;
+      snapshot.log_length = m_log_mode == LogMode::REPLAY ? m_input_log.checksums.size() : 0;
+      snapshot.replay_desynced = m_replay_desynced;
+      snapshot.replay_desync_tick = m_replay_desync_tick;
+
+      m_snapshots.Publish();
+   }
+
+   void AppState::run_tick()
+   {
+      const uint64_t tick = m_world.m_tick;
+      if (m_log_mode == LogMode::REPLAY) {
+         m_input_log.ApplyDue(m_world, m_replay_cursor);
+      }
+
+      m_world.update(World::TICK_SECONDS);
+
+      m_state_recorder.Record(m_world);
+
+      if (m_log_mode == LogMode::RECORD) {
+         m_input_log.RecordChecksum(tick, m_world.Checksum());
+      }
+      else if (m_log_mode == LogMode::REPLAY) {
+         if (!m_replay_desynced && !m_input_log.Verify(tick, m_world.Checksum())) {
+            m_replay_desynced = true;
+            m_replay_desync_tick = tick;
+            TraceLog(LOG_WARNING, "INPUTLOG: '%s' desynced at tick %llu", m_log_path.c_str(), (unsigned long long)tick);
+         }
+
+         // note: at the end of the log the world simply carries on live
+         if (m_input_log.IsFinished(m_world.m_tick, m_replay_cursor)) {
+            TraceLog(LOG_INFO, "INPUTLOG: Replay of '%s' finished at tick %llu%s", m_log_path.c_str(), (unsigned long long)m_world.m_tick, m_replay_desynced ? ", desynced" : "");
+            m_log_mode = LogMode::NONE;
+         }
+      }
+   }
+
    void AppState::render() const
    {
-      m_world.render();
+      PROFILE_SCOPE(profiler::FrameRender);
+      const Rectangle view = camera_view();
+      BeginMode2D(m_camera);
+      m_view_world.render(view);
       if (m_mode == Mode::EDIT) {
-         m_editor.render();
+         // note: paths and sense state only exist in the simulated world, which is paused in edit mode, the lock only waits out a step that is still running
+         m_view_world.query_visible_sheep(view, m_editor_sheep);
+         std::lock_guard<std::mutex> lock(m_world_mutex);
+         m_editor.render(view, m_editor_sheep);
       }
+      EndMode2D();
 
+      m_view_world.render_cursor();
+      m_sprite_stats = m_view_world.m_sprite_batch.TakeStats();
+
+      PROFILE_SCOPE(profiler::RenderHud);
       if (m_mode == Mode::EDIT) {
          const int font_size = 40;
          const Color color = MAROON;
@@ -71,6 +531,357 @@ namespace sim
          const int text_y = 8;
          DrawText(text, text_x + 1, text_y + 1, font_size, BLACK);
          DrawText(text, text_x    , text_y    , font_size, color);
+
+         int y = 8;
+         y = render_scheduler_stats(y);
+         y = render_detail_stats(y);
+         y = render_sprite_stats(y);
+         y = render_overlay_stats(y);
+         render_tick_costs(y);
+         render_path_stats(render_profiler(56));
+      }
+
+      if (m_mode == Mode::PLAYBACK) {
+         render_playback();
+      }
+      else {
+         render_speed();
+      }
+   }
+
+   void AppState::render_speed() const
+   {
+      // note: right above the fps counter
+      const int font_size = 20;
+      const int x = 2;
+      const int y = GetScreenHeight() - 40;
+
+      const RenderSnapshot &frame = m_snapshots.Front();
+      const int time_scale = TIME_SCALES[m_time_scale];
+      const char *speed = time_scale == 0 ? "max" : TextFormat("%dx", time_scale);
+      const char *text = TextFormat("Speed %s (1-4): %.0f ticks/s%s", speed, frame.ticks_per_second, frame.budget_hit ? ", capped" : "");
+      DrawText(text, x + 1, y + 1, font_size, BLACK);
+      DrawText(text, x, y, font_size, frame.budget_hit ? ORANGE : LIME);
+
+      if ((LogMode)frame.log_mode == LogMode::NONE) {
+         return;
+      }
+
+      // note: above the speed readout
+      const char *log_text = (LogMode)frame.log_mode == LogMode::RECORD
+         ? TextFormat("Recording '%s': tick %llu", m_log_path.c_str(), (unsigned long long)frame.tick)
+         : TextFormat("Replaying '%s': tick %llu / %zu%s",
+            m_log_path.c_str(),
+            (unsigned long long)frame.tick,
+            frame.log_length,
+            frame.replay_desynced ? TextFormat(", desynced at %llu", (unsigned long long)frame.replay_desync_tick) : "");
+      DrawText(log_text, x + 1, y - 20 + 1, font_size, BLACK);
+      DrawText(log_text, x, y - 20, font_size, frame.replay_desynced ? RED : YELLOW);
+   }
+
+   void AppState::update_playback(float dt)
+   {
+      const int last_frame = m_state_player.FrameCount() - 1;
+
+      if (IsKeyPressed(KEY_SPACE)) {
+         m_playback_paused = !m_playback_paused;
+      }
+      if (IsKeyPressed(KEY_HOME)) {
+         m_playback_frame = 0.0;
+      }
+      if (IsKeyPressed(KEY_END)) {
+         m_playback_frame = last_frame;
+      }
+
+      // note: a single tick while paused, a second of game time while playing
+      const double step = m_playback_paused ? 1.0 : World::TICKS_PER_SECOND;
+      if (IsKeyPressed(KEY_LEFT)) {
+         m_playback_frame -= step;
+      }
+      if (IsKeyPressed(KEY_RIGHT)) {
+         m_playback_frame += step;
+      }
+
+      // note: clicking or dragging on the bar scrubs
+      const Rectangle bar = playback_bar();
+      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), bar)) {
+         m_playback_frame = double(GetMousePosition().x - bar.x) / bar.width * last_frame;
+      }
+      else if (!m_playback_paused) {
+         const int time_scale = TIME_SCALES[m_time_scale];
+         m_playback_frame += double(dt) * World::TICKS_PER_SECOND * (time_scale == 0 ? PLAYBACK_MAX_SCALE : time_scale);
+      }
+
+      m_playback_frame = Math::clamp(m_playback_frame, 0.0, double(last_frame));
+      m_state_player.Seek(int(m_playback_frame), m_view_world);
+   }
+
+   Rectangle AppState::playback_bar() const
+   {
+      const float margin = 200.0f;
+      return { margin, float(GetScreenHeight() - 30), float(GetScreenWidth()) - 2.0f * margin, 16.0f };
+   }
+
+   void AppState::render_playback() const
+   {
+      const int font_size = 20;
+      const int x = 2;
+      const int y = GetScreenHeight() - 60;
+
+      const int frame = m_state_player.current;
+      const int last_frame = m_state_player.FrameCount() - 1;
+      const int time_scale = TIME_SCALES[m_time_scale];
+      const char *speed = time_scale == 0 ? "max" : TextFormat("%dx", time_scale);
+      const char *text = TextFormat("Playback '%s': tick %llu (%d / %d), %s, speed %s (1-4), space pause, arrows step, drag the bar to seek",
+         m_stream_path.c_str(),
+         (unsigned long long)(frame >= 0 ? m_state_player.TickAt(frame) : 0),
+         frame + 1,
+         last_frame + 1,
+         m_playback_paused ? "paused" : "playing",
+         speed);
+      DrawText(text, x + 1, y + 1, font_size, BLACK);
+      DrawText(text, x, y, font_size, YELLOW);
+
+      const Rectangle bar = playback_bar();
+      const float progress = last_frame > 0 ? float(frame) / float(last_frame) : 0.0f;
+      DrawRectangleRec(bar, ColorAlpha(BLACK, 0.5f));
+      DrawRectangleRec({ bar.x, bar.y, bar.width * progress, bar.height }, YELLOW);
+      DrawRectangleLinesEx(bar, 1.0f, WHITE);
+   }
+
+   Rectangle AppState::camera_view() const
+   {
+      const Vector2 min = GetScreenToWorld2D({ 0.0f, 0.0f }, m_camera);
+      const Vector2 max = GetScreenToWorld2D({ float(GetScreenWidth()), float(GetScreenHeight()) }, m_camera);
+      return { min.x, min.y, max.x - min.x, max.y - min.y };
+   }
+
+   int AppState::render_scheduler_stats(int y) const
+   {
+      // note: per worker stats of the last step the simulation ran, worker 0 is the simulation thread
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = 8;
+
+      const RenderSnapshot &frame = m_snapshots.Front();
+      const char *title = TextFormat("Scheduler: %d workers (last simulated step)", (int)frame.worker_stats.size());
+      DrawText(title, x + 1, y + 1, font_size, BLACK);
+      DrawText(title, x, y, font_size, WHITE);
+      y += line_height;
+
+      for (int i = 0; i < (int)frame.worker_stats.size(); i++) {
+         const Scheduler::WorkerStats &stats = frame.worker_stats[i];
+         const char *text = TextFormat("Worker %d: %llu tasks, %llu steals, busy %.2f ms, idle %.2f ms",
+            i,
+            (unsigned long long)stats.tasksRun,
+            (unsigned long long)stats.steals,
+            stats.busySeconds * 1000.0,
+            stats.idleSeconds * 1000.0);
+         DrawText(text, x + 1, y + 1, font_size, BLACK);
+         DrawText(text, x, y, font_size, WHITE);
+         y += line_height;
+      }
+      return y + line_height / 2;
+   }
+
+   int AppState::render_detail_stats(int y) const
+   {
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = 8;
+
+      const char *text = TextFormat("Sheep detail: %d full, %d coarse (off-screen)",
+         m_snapshots.Front().detail_counts[Sheep::FullDetail],
+         m_snapshots.Front().detail_counts[Sheep::CoarseDetail]);
+      DrawText(text, x + 1, y + 1, font_size, BLACK);
+      DrawText(text, x, y, font_size, WHITE);
+      return y + line_height + line_height / 2;
+   }
+
+   int AppState::render_sprite_stats(int y) const
+   {
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = 8;
+
+      const char *text = TextFormat("Sprites: %d quads in %d draw calls (this frame)",
+         m_sprite_stats.quads,
+         m_sprite_stats.drawCalls);
+      DrawText(text, x + 1, y + 1, font_size, BLACK);
+      DrawText(text, x, y, font_size, WHITE);
+      return y + line_height + line_height / 2;
+   }
+
+   int AppState::render_overlay_stats(int y) const
+   {
+      // note: what the editor's debug drawing cost on the cpu, the gpu draws it along with the rest of the frame
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = 8;
+
+      const Editor::OverlayStats &stats = m_editor.m_overlay_stats;
+      const char *text = TextFormat("Overlay: %.2f ms, %d labels (%d formatted), %d path tiles (this frame)",
+         stats.seconds * 1000.0,
+         stats.labels,
+         stats.labels_formatted,
+         stats.path_quads);
+      DrawText(text, x + 1, y + 1, font_size, BLACK);
+      DrawText(text, x, y, font_size, WHITE);
+      y += line_height;
+
+      const char *heatmap = m_editor.currentHeatmap == Editor::noHeatmap
+         ? "Heatmap (H): off"
+         : TextFormat("Heatmap (H): %s, full colour at %u, %d tiles uploaded",
+            Heatmap::LAYER_NAMES[m_editor.currentHeatmap - 1],
+            m_editor.m_heatmap_scale,
+            stats.heatmap_tiles);
+      DrawText(heatmap, x + 1, y + 1, font_size, BLACK);
+      DrawText(heatmap, x, y, font_size, WHITE);
+      return y + line_height + line_height / 2;
+   }
+
+   int AppState::render_profiler(int y) const
+   {
+      // note: on the right, below the edit mode title. A bar per thread's frame, stacked from the zones that do not overlap, against twice the frame budget
+      const int font_size = 10;
+      const int line_height = 12;
+      const int bar_width = 400;
+      const int bar_height = 10;
+      const int x = GetScreenWidth() - bar_width - 16;
+      const double budget = FRAME_SECONDS * 1000.0;
+      const Color colours[] = { RED, ORANGE, GOLD, LIME, SKYBLUE, VIOLET, PINK, BEIGE, DARKGREEN, MAGENTA };
+
+      profiler::ZoneStats stats[profiler::ZONE_COUNT];
+      profiler::TakeStats(stats);
+
+      for (profiler::Zone root : { profiler::Frame, profiler::Step }) {
+         const char *title = TextFormat("%s: %.2f ms avg, %.2f ms p99 (budget %.1f ms, %d frames)",
+            root == profiler::Frame ? "Main thread frame" : "Simulation step",
+            stats[root].avg,
+            stats[root].p99,
+            budget,
+            profiler::HISTORY_FRAMES);
+         DrawText(title, x + 1, y + 1, font_size, BLACK);
+         DrawText(title, x, y, font_size, WHITE);
+         y += line_height;
+
+         DrawRectangle(x, y, bar_width, bar_height, ColorAlpha(BLACK, 0.5f));
+         float bar_x = float(x);
+         int colour = 0;
+         for (int zone = 0; zone < profiler::ZONE_COUNT; zone++) {
+            if (!profiler::ZONES[zone].inBar || profiler::RootOf((profiler::Zone)zone) != root) {
+               continue;
+            }
+            const float width = float(stats[zone].avg / (2.0 * budget) * bar_width);
+            DrawRectangleRec({ bar_x, float(y), Math::min(width, float(x + bar_width) - bar_x), float(bar_height) }, colours[colour++ % _countof(colours)]);
+            bar_x = Math::min(bar_x + width, float(x + bar_width));
+         }
+         DrawLine(x + bar_width / 2, y - 2, x + bar_width / 2, y + bar_height + 2, WHITE);
+         y += bar_height + 4;
+
+         // note: milliseconds in columns, the font is proportional
+         const char *columns[] = { "Zone", "last", "min", "avg", "p99" };
+         for (int column = 0; column < (int)_countof(columns); column++) {
+            const int column_x = column == 0 ? x : x + 150 + (column - 1) * 60;
+            DrawText(columns[column], column_x + 1, y + 1, font_size, BLACK);
+            DrawText(columns[column], column_x, y, font_size, LIGHTGRAY);
+         }
+         y += line_height;
+
+         colour = 0;
+         for (int zone = 0; zone < profiler::ZONE_COUNT; zone++) {
+            if (profiler::RootOf((profiler::Zone)zone) != root) {
+               continue;
+            }
+            const int indent = profiler::DepthOf((profiler::Zone)zone) * 8;
+            const Color name_colour = profiler::ZONES[zone].inBar ? colours[colour++ % _countof(colours)] : WHITE;
+            DrawText(profiler::ZONES[zone].name, x + indent + 1, y + 1, font_size, BLACK);
+            DrawText(profiler::ZONES[zone].name, x + indent, y, font_size, name_colour);
+
+            const double times[] = { stats[zone].last, stats[zone].min, stats[zone].avg, stats[zone].p99 };
+            for (int column = 0; column < (int)_countof(times); column++) {
+               const char *text = TextFormat("%.2f", times[column]);
+               DrawText(text, x + 150 + column * 60 + 1, y + 1, font_size, BLACK);
+               DrawText(text, x + 150 + column * 60, y, font_size, WHITE);
+            }
+            y += line_height;
+         }
+         y += line_height / 2;
+      }
+      return y;
+   }
+
+   int AppState::render_path_stats(int y) const
+   {
+      // note: every A* search since the world was created, per agent kind and the state it searched in. Latencies are histogram buckets, so the percentiles are upper bounds
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = GetScreenWidth() - 400 - 16;
+
+      PathTelemetry::Table table;
+      m_world.m_path_telemetry.Copy(table);
+
+      const char *columns[] = { "Path searches", "count", "failed", "expanded", "p50 us", "p95 us", "p99 us" };
+      for (int column = 0; column < (int)_countof(columns); column++) {
+         const int column_x = column == 0 ? x : x + 100 + (column - 1) * 50;
+         DrawText(columns[column], column_x + 1, y + 1, font_size, BLACK);
+         DrawText(columns[column], column_x, y, font_size, LIGHTGRAY);
+      }
+      y += line_height;
+
+      for (int kind = 0; kind < PathAgent::KIND_COUNT; kind++) {
+         for (int state = 0; state < PathTelemetry::STATE_COUNTS[kind]; state++) {
+            const PathTelemetry::Bucket &bucket = table[kind][state];
+            if (bucket.searches == 0) {
+               continue;
+            }
+            const char *name = TextFormat("%s %s", PathTelemetry::KIND_NAMES[kind], PathTelemetry::STATE_NAMES[kind][state]);
+            DrawText(name, x + 1, y + 1, font_size, BLACK);
+            DrawText(name, x, y, font_size, WHITE);
+
+            const double values[] = {
+               (double)bucket.searches,
+               (double)bucket.failures,
+               (double)bucket.expanded / (double)bucket.searches,
+               bucket.Percentile(0.50),
+               bucket.Percentile(0.95),
+               bucket.Percentile(0.99),
+            };
+            for (int column = 0; column < (int)_countof(values); column++) {
+               const char *text = TextFormat("%.0f", values[column]);
+               DrawText(text, x + 100 + column * 50 + 1, y + 1, font_size, BLACK);
+               DrawText(text, x + 100 + column * 50, y, font_size, WHITE);
+            }
+            y += line_height;
+         }
+      }
+      return y;
+   }
+
+   int AppState::render_tick_costs(int y) const
+   {
+      // note: summed over all threads, so parallel passes can add up to more than the tick took
+      const int font_size = 10;
+      const int line_height = 12;
+      const int x = 8;
+
+      const RenderSnapshot &frame = m_snapshots.Front();
+      double total = 0.0;
+      for (double cost : frame.tick_costs) {
+         total += cost;
+      }
+
+      const char *title = TextFormat("Tick cost: %.3f ms (average over the last second)", total);
+      DrawText(title, x + 1, y + 1, font_size, BLACK);
+      DrawText(title, x, y, font_size, WHITE);
+      y += line_height;
+
+      for (int pass = 0; pass < World::PASS_COUNT; pass++) {
+         const char *text = TextFormat("%s: %.3f ms", World::PASS_NAMES[pass], frame.tick_costs[pass]);
+         DrawText(text, x + 1, y + 1, font_size, BLACK);
+         DrawText(text, x, y, font_size, WHITE);
+         y += line_height;
       }
+      return y;
    }
 }
@@ -2,45 +2,14 @@
 
 #include "editor.hpp"
 #include "world.hpp"
+#include "simthread.hpp"
+#include <rlgl.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 
 namespace sim
 {
-	namespace editor
-	{
-		void set_ground_active(std::vector<Ground>& ground, const Point& coord, const Point& world_size)
-		{
-			const int index = coord.y * world_size.x + coord.x;
-			if (!ground[index].is_walkable()) {
-				ground[index].set_walkable(true);
-			}
-		}
-
-		void set_ground_inactive(std::vector<Ground>& ground, const Point& coord, const Point& world_size)
-		{
-			const int index = coord.y * world_size.x + coord.x;
-			if (ground[index].is_walkable()) {
-				ground[index].set_walkable(false);
-			}
-		}
-
-		void set_grass_active(std::vector<Grass>& grass, const Point& coord, const Point& world_size)
-		{
-			const int index = coord.y * world_size.x + coord.x;
-			if (!grass[index].is_alive()) {
-				const float age = GetRandomValue(0, 100) / 100.0f;
-				grass[index].set_age(age);
-			}
-		}
-
-		void set_grass_inactive(std::vector<Grass>& grass, const Point& coord, const Point& world_size)
-		{
-			const int index = coord.y * world_size.x + coord.x;
-			if (grass[index].is_alive()) {
-				grass[index].set_age(0.0f);
-			}
-		}
-	} // !editor
-
 	Editor::Editor(World& world)
 		: m_world(world)
 	{
@@ -52,6 +21,10 @@ namespace sim
 
 	void Editor::shut()
 	{
+		if (m_heatmap_texture.id != 0) {
+			UnloadTexture(m_heatmap_texture);
+			m_heatmap_texture = {};
+		}
 	}
 
 	bool Editor::update(float dt)
@@ -72,9 +45,25 @@ namespace sim
 			currentSettings = (Settings)setting;
 		}
 
-		// note: hover tile info
+		if (IsKeyPressed(KEY_H)) {
+			currentHeatmap = HeatmapSettings((currentHeatmap + 1) % (Heatmap::LAYER_COUNT + 1));
+		}
+
+		// note: save/load the whole world, or export the terrain as a map (start with --map to use it)
+		if (IsKeyPressed(KEY_F5)) {
+			m_commands->post({ SimCommand::SAVE_SNAPSHOT });
+		}
+		if (IsKeyPressed(KEY_F6)) {
+			m_commands->post({ SimCommand::EXPORT_MAP });
+		}
+		// note: a loaded world did not come from the recorded inputs, so it would break a recording or replay
+		if (IsKeyPressed(KEY_F9) && !m_recording && !m_locked) {
+			m_commands->post({ SimCommand::LOAD_SNAPSHOT });
+		}
+
+		// note: hover tile info, the mouse is turned into world coordinates first
 		m_is_tile_valid = false;
-		m_cursor = GetMousePosition();
+		m_cursor = m_camera ? GetScreenToWorld2D(GetMousePosition(), *m_camera) : GetMousePosition();
 		if (CheckCollisionPointRec(m_cursor.to_vec2(), world_bounds)) {
 			const Point cursor_world_position = m_cursor - world_offset;
 			const Point hover_coord = cursor_world_position / tile_size;
@@ -88,183 +77,387 @@ namespace sim
 			}
 		}
 
-		// note: edit mode logic
-		if (m_is_tile_valid) {
+		// note: edit mode logic, during a replay the edits come from the log
+		if (m_is_tile_valid && !m_locked) {
 			if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-				editor::set_ground_active(m_world.m_ground, m_tile_coord, world_size);
-				editor::set_grass_active(m_world.m_grass, m_tile_coord, world_size);
+				set_tile_active(true);
 			}
 
 			if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
-				editor::set_ground_inactive(m_world.m_ground, m_tile_coord, world_size);
-				editor::set_grass_inactive(m_world.m_grass, m_tile_coord, world_size);
+				set_tile_active(false);
 			}
 		}
 
 		return true;
 	}
 
-	void Editor::render() const
+	void Editor::set_tile_active(bool active)
 	{
-		const auto& world_bounds = m_world.m_world_bounds;
+		SimCommand command;
+		command.type = active ? SimCommand::TILE_ACTIVE : SimCommand::TILE_INACTIVE;
+		command.x = (float)m_tile_coord.x;
+		command.y = (float)m_tile_coord.y;
+		m_commands->post(command);
+	}
+
+	static Color HeatColour(uint32_t count, uint32_t scale)
+	{
+		if (count == 0) {
+			return BLANK;
+		}
+		const float t = float(count) / float(scale);
+		return { 255, (unsigned char)(255.0f * (1.0f - t)), 0, (unsigned char)(60.0f + 160.0f * t) };
+	}
+
+	void Editor::update_heatmap()
+	{
+		m_overlay_stats.heatmap_tiles = 0;
+		if (currentHeatmap == noHeatmap) {
+			return;
+		}
+
+		const Heatmap::Layer layer = Heatmap::Layer(currentHeatmap - 1);
+		const Point& size = m_world.m_world_size;
+		const int tile_count = size.x * size.y;
+		bool full = false;
+
+		if (m_heatmap_texture.id == 0 || m_heatmap_texture.width != size.x || m_heatmap_texture.height != size.y) {
+			if (m_heatmap_texture.id != 0) {
+				UnloadTexture(m_heatmap_texture);
+			}
+			Image image = GenImageColor(size.x, size.y, BLANK);
+			m_heatmap_texture = LoadTextureFromImage(image);
+			UnloadImage(image);
+			m_heatmap_pixels.assign(tile_count, BLANK);
+			full = true;
+		}
+
+		// note: a new layer or a doubled scale changes every pixel, otherwise only the tiles counted since the last frame are uploaded, a row span per dirty row
+		const uint32_t scale = m_world.m_heatmap.Scale(layer);
+		full |= currentHeatmap != m_heatmap_uploaded || scale != m_heatmap_scale;
+		m_heatmap_uploaded = currentHeatmap;
+		m_heatmap_scale = scale;
+
+		m_world.m_heatmap.TakeDirty(layer, m_heatmap_dirty);
+		full |= (int)m_heatmap_dirty.size() > tile_count / 4;
+
+		const std::vector<uint32_t>& counts = m_world.m_heatmap.layers[layer].counts;
+		if (full) {
+			for (int i = 0; i < tile_count; i++) {
+				m_heatmap_pixels[i] = HeatColour(counts[i], scale);
+			}
+			UpdateTexture(m_heatmap_texture, m_heatmap_pixels.data());
+			m_overlay_stats.heatmap_tiles = tile_count;
+			return;
+		}
+
+		std::sort(m_heatmap_dirty.begin(), m_heatmap_dirty.end());
+		for (size_t first = 0; first < m_heatmap_dirty.size();) {
+			const int row = m_heatmap_dirty[first] / size.x;
+			size_t last = first;
+			while (last + 1 < m_heatmap_dirty.size() && m_heatmap_dirty[last + 1] / size.x == row) {
+				last++;
+			}
+			for (size_t i = first; i <= last; i++) {
+				m_heatmap_pixels[m_heatmap_dirty[i]] = HeatColour(counts[m_heatmap_dirty[i]], scale);
+			}
+
+			const int left = m_heatmap_dirty[first] % size.x;
+			const int right = m_heatmap_dirty[last] % size.x;
+			UpdateTextureRec(m_heatmap_texture, { float(left), float(row), float(right - left + 1), 1.0f }, &m_heatmap_pixels[m_heatmap_dirty[first]]);
+			m_overlay_stats.heatmap_tiles += int(last - first + 1);
+			first = last + 1;
+		}
+	}
+
+	bool Editor::update_label(std::vector<Label>& labels, int index, const LabelKey& key) const
+	{
+		if (index >= (int)labels.size()) {
+			labels.resize(index + 1);
+		}
+		Label& label = labels[index];
+		if (label.valid && label.key == key) {
+			return false;
+		}
+		label.key = key;
+		label.valid = true;
+		m_overlay_stats.labels_formatted++;
+		return true;
+	}
+
+	static uint32_t LabelBits(float value)
+	{
+		return std::bit_cast<uint32_t>(value);
+	}
+
+	static void DrawLabel(const std::string& text, const Vector2& position, float radius)
+	{
+		const int font_size = 10;
+		DrawText(text.c_str(), (int)position.x + (int)radius, int(position.y - radius), font_size, BLACK);
+		DrawText(text.c_str(), (int)position.x - 1 + (int)radius, int(position.y - radius - 1), font_size, WHITE);
+	}
+
+	void Editor::render(const Rectangle& view, const std::vector<int>& visible_sheep) const
+	{
+		PROFILE_SCOPE(profiler::RenderEditor);
+		using Clock = std::chrono::steady_clock;
+		const Clock::time_point start = Clock::now();
+		m_overlay_stats = { 0.0, 0, 0, 0, m_overlay_stats.heatmap_tiles };
+
 		const auto& world_offset = m_world.m_world_offset;
-		const auto& world_size = m_world.m_world_size;
 		const auto& tile_size = m_world.m_tile_size;
 
-		// note: debug grid
+		// note: only the part of the world in view is drawn, paths are cut to the visible tiles
+		Point first, last;
+		m_world.visible_tiles(view, first, last);
+		auto is_tile_visible = [&first, &last](const Point& tile) {
+			return tile.x >= first.x && tile.x < last.x && tile.y >= first.y && tile.y < last.y;
+		};
+		const Rectangle visible{ view.x - World::RENDER_MARGIN, view.y - World::RENDER_MARGIN, view.width + 2.f * World::RENDER_MARGIN, view.height + 2.f * World::RENDER_MARGIN };
+
+		// note: the heatmap is stretched over the whole world, the gpu clips it to the view
+		if (currentHeatmap != noHeatmap && m_heatmap_uploaded == currentHeatmap) {
+			DrawTexturePro(m_heatmap_texture,
+				{ 0.0f, 0.0f, float(m_heatmap_texture.width), float(m_heatmap_texture.height) },
+				{ float(world_offset.x), float(world_offset.y), float(m_world.m_world_size.x * tile_size.x), float(m_world.m_world_size.y * tile_size.y) },
+				{},
+				0.0f,
+				WHITE);
+		}
+
+		// note: debug grid, the lines of the visible rows and columns
 		const Color color = ColorAlpha(RAYWHITE, 0.3f);
-		for (int y = 0; y <= world_size.y; y++) {
-			const int ty = y * tile_size.y;
-			DrawLine((int)world_bounds.x,
-				(int)world_bounds.y + ty,
-				(int)(world_bounds.x + world_bounds.width),
-				(int)world_bounds.y + ty,
-				color);
+		const int left = world_offset.x + first.x * tile_size.x;
+		const int right = world_offset.x + last.x * tile_size.x;
+		const int top = world_offset.y + first.y * tile_size.y;
+		const int bottom = world_offset.y + last.y * tile_size.y;
+		for (int y = first.y; y <= last.y; y++) {
+			const int ty = world_offset.y + y * tile_size.y;
+			DrawLine(left, ty, right, ty, color);
 		}
-		for (int x = 0; x <= world_size.x; x++) {
-			const int tx = x * tile_size.x;
-			DrawLine((int)world_bounds.x + tx,
-				(int)world_bounds.y,
-				(int)world_bounds.x + tx,
-				(int)(world_bounds.y + world_bounds.height),
-				color);
+		for (int x = first.x; x <= last.x; x++) {
+			const int tx = world_offset.x + x * tile_size.x;
+			DrawLine(tx, top, tx, bottom, color);
 		}
 
+		// note: only agents near the view get an overlay, the herders are drawn offset by half their origin
+		const Vector2 cursor = m_cursor.to_vec2();
+		auto herder_position = [](const Herder& herder) { return herder.m_position + herder.m_origin / 2.f; };
+
+		m_visible_wolves.clear();
+		for (int i = 0; i < (int)m_world.m_wolves.size(); i++) {
+			if (CheckCollisionPointRec(m_world.m_wolves[i].m_position, visible)) {
+				m_visible_wolves.push_back(i);
+			}
+		}
+		m_visible_herders.clear();
+		for (int i = 0; i < (int)m_world.m_herders.size(); i++) {
+			if (CheckCollisionPointRec(herder_position(m_world.m_herders[i]), visible)) {
+				m_visible_herders.push_back(i);
+			}
+		}
+		auto is_sheep_shown = [this](int index) {
+			return index < (int)m_world.m_sheep.size() && m_world.m_sheep[index].isAlive;
+		};
+
+		// note: the path tiles of one agent class go into one batch, drawn as a single mesh with the class colour
+		const Texture2D white = { rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+		auto add_path = [&](const std::vector<Point>& path, const Color& colour) {
+			for (const Point& tile : path) {
+				if (is_tile_visible(tile)) {
+					m_path_batch.Add({ 0.0f, 0.0f, 1.0f, 1.0f },
+						{ float(world_offset.x + tile.x * tile_size.x), float(world_offset.y + tile.y * tile_size.y), float(tile_size.x), float(tile_size.y) },
+						{},
+						colour);
+				}
+			}
+		};
+
+		if (currentSettings == showAllPaths || currentSettings == showOnlySheepPath || currentSettings == showSheepAndHerderPath || currentSettings == showWolfAndSheepPath) {
+			const Color sheepPathColour = { 139,102,204,100 };
+			m_path_batch.Begin(white);
+			for (int index : visible_sheep) {
+				if (is_sheep_shown(index)) {
+					add_path(m_world.m_sheep[index].path, sheepPathColour);
+				}
+			}
+			m_overlay_stats.path_quads += (int)m_path_batch.quads.size();
+			m_path_batch.End();
+		}
+		if (currentSettings == showAllPaths || currentSettings == showOnlyWolfPath || currentSettings == showHerderAndWolfPath || currentSettings == showWolfAndSheepPath) {
+			const Color wolfPathColour = { 204,102,175,150 };
+			m_path_batch.Begin(white);
+			for (int index : m_visible_wolves) {
+				add_path(m_world.m_wolves[index].path, wolfPathColour);
+			}
+			m_overlay_stats.path_quads += (int)m_path_batch.quads.size();
+			m_path_batch.End();
+		}
+		if (currentSettings == showAllPaths || currentSettings == showOnlyHerderPath || currentSettings == showHerderAndWolfPath || currentSettings == showSheepAndHerderPath) {
+			const Color herderPathColour = { 102,234,201,100 };
+			m_path_batch.Begin(white);
+			for (int index : m_visible_herders) {
+				add_path(m_world.m_herders[index].path, herderPathColour);
+			}
+			m_overlay_stats.path_quads += (int)m_path_batch.quads.size();
+			m_path_batch.End();
+		}
+		// note: the batch counts into the sprite stats otherwise, the overlay has its own readout
+		m_path_batch.TakeStats();
+
+		int shown_agents = (int)m_visible_wolves.size() + (int)m_visible_herders.size();
+		for (int index : visible_sheep) {
+			shown_agents += is_sheep_shown(index) ? 1 : 0;
+		}
+		const bool label_all = shown_agents <= MAX_LABELS;
+
 		// note: sheep debug info
-		for (const auto& sheep : m_world.m_sheep) {
-			if (!sheep.isAlive) {
+		for (int index : visible_sheep) {
+			if (!is_sheep_shown(index)) {
 				continue;
 			}
-			
-			bool shouldShowPath = currentSettings == showAllPaths || currentSettings == showOnlySheepPath || currentSettings == showSheepAndHerderPath || currentSettings == showWolfAndSheepPath;
-			if (!sheep.path.empty () && shouldShowPath)
-			{
-				Color sheepPathColour = {139,102,204,100};
-				for (auto tile : sheep.path)
-				{
-					//Draw the path
-					DrawRectangle (world_offset.x + tile.x * tile_size.x,
-						world_offset.y + tile.y * tile_size.y,
-						tile_size.x,
-						tile_size.y,
-						sheepPathColour);
+			const Sheep& sheep = m_world.m_sheep[index];
 
-				}
-			}
 			// note: render collider
 			DrawCircleLinesV(sheep.m_position, sheep.m_radius, MAGENTA);
 
 			// note: walking direction
 			DrawLineV(sheep.m_position, sheep.m_position + sheep.m_direction * Sheep::WALKING_SPEED, BLACK);
 
+			if (!label_all && !CheckCollisionPointCircle(cursor, sheep.m_position, sheep.m_radius)) {
+				continue;
+			}
 
-			const int font_size = 10;
-			const char* stateName = "Invalid";
-			switch (sheep.currentState) {
-			case sheep.Hungry:
-				stateName = "Hungry";
-				break;
-			case sheep.Satiated:
-				stateName = "Satiated";
-				break;
-			case sheep.Reproducing:
-				stateName = "Reproducing";
-				break;
-			case sheep.Afraid:
-				stateName = "Afraid";
-				break;
+			const LabelKey key = {
+				(uint32_t)sheep.currentState,
+				sheep.canReproduce,
+				sheep.isMatedWith,
+				LabelBits(sheep.age),
+				LabelBits(sheep.amountGrassEaten),
+				LabelBits(sheep.velocity),
+				sheep.isBeingHunted,
+				(uint32_t)sheep.pathStats.searches,
+				(uint32_t)sheep.pathStats.failures,
+				LabelBits(sheep.pathStats.lastMicroseconds),
+			};
+			if (update_label(m_sheep_labels, index, key)) {
+				const char* stateName = "Invalid";
+				switch (sheep.currentState) {
+				case sheep.Hungry:
+					stateName = "Hungry";
+					break;
+				case sheep.Satiated:
+					stateName = "Satiated";
+					break;
+				case sheep.Reproducing:
+					stateName = "Reproducing";
+					break;
+				case sheep.Afraid:
+					stateName = "Afraid";
+					break;
+				}
+				m_sheep_labels[index].text = TextFormat("State: %s\nCan Reproduce: %s\nMated With: %s\nAge: %.2f\nAmount Grass Eaten: %.0f\nVelocity: %.1f\nHunted: %s\nPaths: %d (%d failed), last %.0f us",
+					stateName,
+					sheep.canReproduce ? "Yes" : "No",
+					sheep.isMatedWith ? "Yes" : "No",
+					sheep.age,
+					sheep.amountGrassEaten,
+					sheep.velocity,
+					sheep.isBeingHunted ? "Yes" : "No",
+					sheep.pathStats.searches,
+					sheep.pathStats.failures,
+					sheep.pathStats.lastMicroseconds);
 			}
-			const char* text = TextFormat("State: %s\nCan Reproduce: %s\nMated With: %s\nAge: %.2f\nAmount Grass Eaten: %.0f\nVelocity: %.1f\nHunted: %s",
-				stateName,
-				sheep.canReproduce ? "Yes" : "No",
-				sheep.isMatedWith ? "Yes" : "No",
-				sheep.age,
-				sheep.amountGrassEaten,
-				sheep.velocity,
-				sheep.isBeingHunted ? "Yes" : "No");
-			DrawText(text, (int)sheep.m_position.x + (int)sheep.m_radius, int(sheep.m_position.y - sheep.m_radius), font_size, BLACK);
-			DrawText(text, (int)sheep.m_position.x - 1 + (int)sheep.m_radius, int(sheep.m_position.y - sheep.m_radius - 1), font_size, WHITE);
+			DrawLabel(m_sheep_labels[index].text, sheep.m_position, sheep.m_radius);
+			m_overlay_stats.labels++;
 		}
 
 		// note: Wolf Debug Info
+		for (int index : m_visible_wolves)
 		{
-			bool shouldShowPath = currentSettings == showAllPaths || currentSettings == showOnlyWolfPath || currentSettings == showHerderAndWolfPath || currentSettings == showWolfAndSheepPath;
-			if (!m_world.wolf.path.empty () && shouldShowPath)
-			{
-				Color wolfPathColour = {204,102,175,150};
-				for (auto tile : m_world.wolf.path)
-				{
-					//Draw the path
-					DrawRectangle (world_offset.x + tile.x * tile_size.x,
-						world_offset.y + tile.y * tile_size.y,
-						tile_size.x,
-						tile_size.y,
-						wolfPathColour);
-
-				}
-			}
+			const Wolf& wolf = m_world.m_wolves[index];
 
 			// note: render collider
-			DrawCircleLinesV(m_world.wolf.m_position, m_world.wolf.m_radius, PINK);
+			DrawCircleLinesV(wolf.m_position, wolf.m_radius, PINK);
 
 			// note: walking direction
-			DrawLineV(m_world.wolf.m_position, m_world.wolf.m_position + m_world.wolf.m_direction * Wolf::WALKING_SPEED, BLACK);
+			DrawLineV(wolf.m_position, wolf.m_position + wolf.m_direction * Wolf::WALKING_SPEED, BLACK);
 
-			const char* stateName = "Invalid";
-			switch (m_world.wolf.currentState) {
-			case m_world.wolf.Hungry:
-				stateName = "Hungry";
-				break;
-			case m_world.wolf.Satiated:
-				stateName = "Satiated";
-				break;
-			case m_world.wolf.Asleep:
-				stateName = "Asleep";
-				break;
+			if (!label_all && !CheckCollisionPointCircle(cursor, wolf.m_position, wolf.m_radius)) {
+				continue;
 			}
 
-			const int font_size = 10;
-			const char* text = TextFormat("State: %s\nHas a Target: %s\nAmount Sheep Eaten: %d\nVelocity: %.1f\nTime Asleep: %.2f",
-				stateName,
-				m_world.wolf.hasATarget ? "Yes" : "No",
-				m_world.wolf.amountSheepEaten,
-				m_world.wolf.velocity,
-				m_world.wolf.timeAsleep);
-			DrawText(text, (int)m_world.wolf.m_position.x + (int)m_world.wolf.m_radius, int(m_world.wolf.m_position.y - m_world.wolf.m_radius), font_size, BLACK);
-			DrawText(text, (int)m_world.wolf.m_position.x - 1 + (int)m_world.wolf.m_radius, int(m_world.wolf.m_position.y - m_world.wolf.m_radius - 1), font_size, WHITE);
-			
+			const LabelKey key = {
+				(uint32_t)wolf.currentState,
+				wolf.hasATarget,
+				(uint32_t)wolf.amountSheepEaten,
+				LabelBits(wolf.velocity),
+				LabelBits(wolf.timeAsleep),
+				(uint32_t)wolf.pathStats.searches,
+				(uint32_t)wolf.pathStats.failures,
+				LabelBits(wolf.pathStats.lastMicroseconds),
+			};
+			if (update_label(m_wolf_labels, index, key)) {
+				const char* stateName = "Invalid";
+				switch (wolf.currentState) {
+				case wolf.Hungry:
+					stateName = "Hungry";
+					break;
+				case wolf.Satiated:
+					stateName = "Satiated";
+					break;
+				case wolf.Asleep:
+					stateName = "Asleep";
+					break;
+				}
+				m_wolf_labels[index].text = TextFormat("State: %s\nHas a Target: %s\nAmount Sheep Eaten: %d\nVelocity: %.1f\nTime Asleep: %.2f\nPaths: %d (%d failed), last %.0f us",
+					stateName,
+					wolf.hasATarget ? "Yes" : "No",
+					wolf.amountSheepEaten,
+					wolf.velocity,
+					wolf.timeAsleep,
+					wolf.pathStats.searches,
+					wolf.pathStats.failures,
+					wolf.pathStats.lastMicroseconds);
+			}
+			DrawLabel(m_wolf_labels[index].text, wolf.m_position, wolf.m_radius);
+			m_overlay_stats.labels++;
 		}
 
 		// note: herder debug info
+		for (int index : m_visible_herders)
 		{
-			bool shouldShowPath = currentSettings == showAllPaths || currentSettings == showOnlyHerderPath || currentSettings == showHerderAndWolfPath || currentSettings == showSheepAndHerderPath;
-			if (!m_world.herder.path.empty () && shouldShowPath)
-			{
-				Color herderPathColour = {102,234,201,100};
-				for (auto tile : m_world.herder.path)
-				{
-					//Draw the path
-					DrawRectangle (world_offset.x + tile.x * tile_size.x,
-						world_offset.y + tile.y * tile_size.y,
-						tile_size.x,
-						tile_size.y,
-						herderPathColour);
-				}
-			}
-			Vector2 drawPosition = m_world.herder.m_position + m_world.herder.m_origin  /2.f;
+			const Herder& herder = m_world.m_herders[index];
+			const Vector2 drawPosition = herder_position(herder);
+
 			// note: render collider
-			DrawCircleLinesV (drawPosition, m_world.herder.m_radius, MAGENTA);
+			DrawCircleLinesV (drawPosition, herder.m_radius, MAGENTA);
 
 			// note: walking direction
-			DrawLineV (drawPosition, drawPosition + m_world.herder.m_direction * Herder::WALKING_SPEED, BLACK);
+			DrawLineV (drawPosition, drawPosition + herder.m_direction * Herder::WALKING_SPEED, BLACK);
 
+			if (!label_all && !CheckCollisionPointCircle(cursor, drawPosition, herder.m_radius)) {
+				continue;
+			}
 
-			const int font_size = 10;
-			const char* text = TextFormat ("Position: %0.f, %0.f\nIs Attacked: %s",
-				m_world.herder.m_position.x, m_world.herder.m_position.y, 
-				m_world.herder.isAttacked ? "Yes" : "No");
-			DrawText (text, (int)drawPosition.x + (int)m_world.herder.m_radius, int (drawPosition.y - m_world.herder.m_radius), font_size, BLACK);
-			DrawText (text, (int)drawPosition.x - 1 + (int)m_world.herder.m_radius, int (drawPosition.y - m_world.herder.m_radius - 1), font_size, WHITE);
+			const LabelKey key = {
+				LabelBits(herder.m_position.x),
+				LabelBits(herder.m_position.y),
+				herder.isAttacked,
+				(uint32_t)herder.pathStats.searches,
+				(uint32_t)herder.pathStats.failures,
+				LabelBits(herder.pathStats.lastMicroseconds),
+			};
+			if (update_label(m_herder_labels, index, key)) {
+				m_herder_labels[index].text = TextFormat ("Position: %0.f, %0.f\nIs Attacked: %s\nPaths: %d (%d failed), last %.0f us",
+					herder.m_position.x, herder.m_position.y,
+					herder.isAttacked ? "Yes" : "No",
+					herder.pathStats.searches,
+					herder.pathStats.failures,
+					herder.pathStats.lastMicroseconds);
+			}
+			DrawLabel(m_herder_labels[index].text, drawPosition, herder.m_radius);
+			m_overlay_stats.labels++;
 		}
 
 
@@ -308,7 +501,8 @@ namespace sim
 				stateName);
 			DrawText(text, x, y, font_size, BLACK);
 			DrawText(text, x - 1, y - 1, font_size, WHITE);
-		}		
+		}
 
+		m_overlay_stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
 	}
 }
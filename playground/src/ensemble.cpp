@@ -0,0 +1,287 @@
+// ensemble.cpp
+
+#include "ensemble.hpp"
+#include "world.hpp"
+#include "StateStream.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+
+namespace sim
+{
+   namespace ensemble
+   {
+      std::vector<float> parse_values(std::string_view text)
+      {
+         std::vector<float> values;
+         while (!text.empty()) {
+            const size_t comma = text.find(',');
+            const std::string value(text.substr(0, comma));
+            values.push_back(std::strtof(value.c_str(), nullptr));
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+         }
+         return values;
+      }
+
+      // note: inserts the suffix before the extension
+      std::string suffixed_path(const std::string& path, const std::string& suffix)
+      {
+         const size_t dot = path.rfind('.');
+         if (dot == std::string::npos) {
+            return path + suffix;
+         }
+         return path.substr(0, dot) + suffix + path.substr(dot);
+      }
+
+      std::string curves_path(const std::string& summary_path)
+      {
+         return suffixed_path(summary_path, "_curves");
+      }
+
+      std::string path_stats_path(const std::string& summary_path)
+      {
+         return suffixed_path(summary_path, "_paths");
+      }
+   }
+
+   bool Ensemble::parse(int argc, char** argv)
+   {
+      for (int i = 1; i + 1 < argc; i++) {
+         const std::string_view argument = argv[i];
+         const char *value = argv[i + 1];
+
+         if (argument == "--ensemble") {
+            seeds_per_combination = std::atoi(value);
+         }
+         else if (argument == "--seed") {
+            first_seed = std::strtoull(value, nullptr, 10);
+         }
+         else if (argument == "--ticks") {
+            ticks = std::strtoull(value, nullptr, 10);
+         }
+         else if (argument == "--sample") {
+            sample_ticks = std::strtoull(value, nullptr, 10);
+         }
+         else if (argument == "--out") {
+            out_path = value;
+         }
+         else if (argument == "--map") {
+            map_path = value;
+         }
+         else if (argument == "--stream") {
+            stream_path = value;
+         }
+         else if (argument == "--param") {
+            // note: key=value1,value2,...
+            const std::string_view text = value;
+            const size_t equals = text.find('=');
+            WorldConfig config;
+            if (equals == std::string_view::npos || !config.Set(text.substr(0, equals), 0.0f)) {
+               TraceLog(LOG_ERROR, "ENSEMBLE: Unknown parameter '%s'", value);
+               return false;
+            }
+            sweeps.push_back({ std::string(text.substr(0, equals)), ensemble::parse_values(text.substr(equals + 1)) });
+         }
+         else {
+            continue;
+         }
+         i++;
+      }
+
+      if (sample_ticks == 0) {
+         sample_ticks = 1;
+      }
+      return true;
+   }
+
+   void Ensemble::build_runs()
+   {
+      // note: every combination of the swept values (the first sweep varies slowest), each with the same seeds
+      runs.clear();
+      std::vector<int> choice(sweeps.size(), 0);
+      while (true) {
+         WorldConfig config;
+         for (int sweep = 0; sweep < (int)sweeps.size(); sweep++) {
+            if (!sweeps[sweep].values.empty()) {
+               config.Set(sweeps[sweep].key, sweeps[sweep].values[choice[sweep]]);
+            }
+         }
+
+         for (int i = 0; i < seeds_per_combination; i++) {
+            runs.push_back({ first_seed + (uint64_t)i, config });
+         }
+
+         int sweep = (int)sweeps.size() - 1;
+         while (sweep >= 0 && ++choice[sweep] >= (int)sweeps[sweep].values.size()) {
+            choice[sweep] = 0;
+            sweep--;
+         }
+         if (sweep < 0) {
+            break;
+         }
+      }
+   }
+
+   bool Ensemble::run(Scheduler& scheduler)
+   {
+      build_runs();
+      results.assign(runs.size(), {});
+
+      TraceLog(LOG_INFO, "ENSEMBLE: %d worlds, %llu ticks each, on %d threads", (int)runs.size(), (unsigned long long)ticks, scheduler.WorkerCount());
+
+      // note: every world starts from the same mapped file, it is only read
+      MapFile map;
+      if (!map_path.empty() && !map.Open(map_path.c_str())) {
+         return false;
+      }
+      const MapFile *shared_map = map_path.empty() ? nullptr : &map;
+
+      // note: one world per task, each world runs its own tick graph serially
+      scheduler.ParallelFor((int)runs.size(), [this, shared_map](int index) { run_one(index, shared_map); });
+
+      log_summary();
+      return true;
+   }
+
+   void Ensemble::run_one(int index, const MapFile* map)
+   {
+      using Clock = std::chrono::steady_clock;
+
+      const Run &entry = runs[index];
+      Result &result = results[index];
+
+      std::unique_ptr<World> world = std::make_unique<World>();
+      world->init(WORLD_WIDTH, WORLD_HEIGHT, nullptr, nullptr, entry.seed, nullptr, entry.config, map);
+
+      auto count_sheep = [&world]() {
+         int alive = 0;
+         for (const Sheep &sheep : world->m_sheep) {
+            alive += sheep.isAlive ? 1 : 0;
+         }
+         return alive;
+      };
+      auto count_grass = [&world]() {
+         int alive = 0;
+         for (const Grass &grass : world->m_grass) {
+            alive += grass.is_alive() ? 1 : 0;
+         }
+         return alive;
+      };
+
+      StateRecorder recorder;
+      if (!stream_path.empty()) {
+         const std::string path = ensemble::suffixed_path(stream_path, "_" + std::to_string(index));
+         recorder.Open(path.c_str(), WORLD_WIDTH, WORLD_HEIGHT, *world, map_path.empty() ? nullptr : map_path.c_str());
+      }
+
+      const Clock::time_point start = Clock::now();
+      for (uint64_t tick = 0; tick < ticks; tick++) {
+         if (tick % sample_ticks == 0) {
+            result.sheep_curve.push_back(count_sheep());
+            result.grass_curve.push_back(count_grass());
+         }
+
+         world->update(World::TICK_SECONDS);
+         recorder.Record(*world);
+         result.sheep_peak = Math::max(result.sheep_peak, count_sheep());
+      }
+
+      result.ticks = ticks;
+      result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      result.sheep_alive = count_sheep();
+      result.sheep_born = (int)world->m_sheep.size() - entry.config.startAmountSheep;
+      result.sheep_died = (int)world->m_sheep.size() - result.sheep_alive;
+      result.grass_tiles = count_grass();
+      result.sheep_curve.push_back(result.sheep_alive);
+      result.grass_curve.push_back(result.grass_tiles);
+      path_stats.Merge(world->m_path_telemetry);
+
+      world->shut();
+   }
+
+   bool Ensemble::write_summary() const
+   {
+      std::ofstream file(out_path);
+      if (!file) {
+         TraceLog(LOG_ERROR, "ENSEMBLE: Could not write '%s'", out_path.c_str());
+         return false;
+      }
+
+      file << "run,seed";
+      for (const Sweep &sweep : sweeps) {
+         file << ',' << sweep.key;
+      }
+      file << ",ticks,seconds,ticks_per_second,sheep_alive,sheep_peak,sheep_born,sheep_died,grass_tiles,survived\n";
+
+      for (int i = 0; i < (int)runs.size(); i++) {
+         const Result &result = results[i];
+         file << i << ',' << runs[i].seed;
+         for (const Sweep &sweep : sweeps) {
+            file << ',' << runs[i].config.Get(sweep.key);
+         }
+         file << ',' << result.ticks
+              << ',' << result.seconds
+              << ',' << (result.seconds > 0.0 ? (double)result.ticks / result.seconds : 0.0)
+              << ',' << result.sheep_alive
+              << ',' << result.sheep_peak
+              << ',' << result.sheep_born
+              << ',' << result.sheep_died
+              << ',' << result.grass_tiles
+              << ',' << (result.sheep_alive > 0 ? 1 : 0) << '\n';
+      }
+      return true;
+   }
+
+   bool Ensemble::write_curves() const
+   {
+      // note: long format, one row per run and sample
+      const std::string path = ensemble::curves_path(out_path);
+      std::ofstream file(path);
+      if (!file) {
+         TraceLog(LOG_ERROR, "ENSEMBLE: Could not write '%s'", path.c_str());
+         return false;
+      }
+
+      file << "run,tick,sheep_alive,grass_tiles\n";
+      for (int i = 0; i < (int)results.size(); i++) {
+         const Result &result = results[i];
+         for (int sample = 0; sample < (int)result.sheep_curve.size(); sample++) {
+            const uint64_t tick = Math::min((uint64_t)sample * sample_ticks, result.ticks);
+            file << i << ',' << tick << ',' << result.sheep_curve[sample] << ',' << result.grass_curve[sample] << '\n';
+         }
+      }
+      return true;
+   }
+
+   bool Ensemble::write_path_stats() const
+   {
+      return path_stats.WriteCsv(ensemble::path_stats_path(out_path).c_str());
+   }
+
+   void Ensemble::log_summary() const
+   {
+      // note: one line per parameter combination, the runs of a combination are next to each other
+      for (int first = 0; first < (int)runs.size(); first += seeds_per_combination) {
+         int survived = 0;
+         double alive = 0.0;
+         double ticks_per_second = 0.0;
+         for (int i = first; i < first + seeds_per_combination; i++) {
+            survived += results[i].sheep_alive > 0 ? 1 : 0;
+            alive += results[i].sheep_alive;
+            ticks_per_second += results[i].seconds > 0.0 ? (double)results[i].ticks / results[i].seconds : 0.0;
+         }
+
+         std::string parameters;
+         for (const Sweep &sweep : sweeps) {
+            parameters += TextFormat(" %s=%g", sweep.key.c_str(), runs[first].config.Get(sweep.key));
+         }
+
+         TraceLog(LOG_INFO, "ENSEMBLE:%s sheep survived %d/%d, %.1f alive on average, %.0f ticks/s per world",
+            parameters.empty() ? " defaults:" : (parameters + ":").c_str(),
+            survived, seeds_per_combination,
+            alive / seeds_per_combination,
+            ticks_per_second / seeds_per_combination);
+      }
+   }
+}
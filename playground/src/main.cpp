@@ -1,11 +1,112 @@
 // main.cpp
 
 #include "appstate.hpp"
+#include "ensemble.hpp"
+#include <cstdlib>
+#include <ctime>
+
+//Returns the value following "name" on the command line, or nullptr
+static const char* FindArgument (int argc, char** argv, std::string_view name)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string_view (argv[i]) == name)
+		{
+			return argv[i + 1];
+		}
+	}
+	return nullptr;
+}
+
+//True if "name" is on the command line
+static bool HasFlag (int argc, char** argv, std::string_view name)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string_view (argv[i]) == name)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//Reads the seed from "--seed <value>", falling back to the current time so every run still differs by default
+static uint64_t ParseSeed (int argc, char** argv)
+{
+	const char* seed = FindArgument (argc, argv, "--seed");
+	return seed ? std::strtoull (seed, nullptr, 10) : (uint64_t)std::time (nullptr);
+}
 
 int main (int argc, char** argv)
 {
 	const int window_width = 1920, window_height = 1080;
 	const std::string_view window_title = "[5SD806] AI Playground";
+	const uint64_t seed = ParseSeed (argc, argv);
+
+	//"--trace <file>" records a Chrome/Perfetto trace of the ticks, path searches and frames, written when the program exits (or on F8)
+	struct TraceGuard {
+		~TraceGuard () { sim::trace::Stop (); }
+	} traceGuard;
+	sim::trace::SetThreadName ("Main");
+	if (const char* trace_path = FindArgument (argc, argv, "--trace"))
+	{
+		sim::trace::Start (trace_path);
+	}
+
+	//Headless batch of worlds, e.g. "--ensemble 8 --ticks 9000 --param sheep.grass_hunting_range=100,150 --out sweep.csv"
+	sim::Ensemble ensemble;
+	if (!ensemble.parse (argc, argv))
+	{
+		return 1;
+	}
+	if (ensemble.enabled ())
+	{
+		const int cores = (int)std::thread::hardware_concurrency ();
+		sim::Scheduler scheduler;
+		scheduler.Start (cores > 1 ? cores - 1 : 0);
+
+		return ensemble.run (scheduler) && ensemble.write_summary () && ensemble.write_curves () && ensemble.write_path_stats () ? 0 : 1;
+	}
+
+	//Replays a recorded input log as fast as possible and checks every tick, e.g. "--replay run.inputlog --headless"
+	//"--path-stats <file>" writes what the A* searches cost per agent kind and state once the run is over
+	const char* replay_path = FindArgument (argc, argv, "--replay");
+	const char* record_path = FindArgument (argc, argv, "--record");
+	const char* path_stats_path = FindArgument (argc, argv, "--path-stats");
+	if (replay_path && HasFlag (argc, argv, "--headless"))
+	{
+		const int cores = (int)std::thread::hardware_concurrency ();
+		sim::Scheduler scheduler;
+		scheduler.Start (cores > 1 ? cores - 1 : 0);
+
+		return sim::InputLog::ReplayHeadless (replay_path, &scheduler, path_stats_path) ? 0 : 1;
+	}
+
+	sim::AppState app;
+	if (replay_path ? !app.replay (replay_path) : record_path && !app.record (record_path))
+	{
+		return 1;
+	}
+	if (path_stats_path)
+	{
+		app.m_path_stats_path = path_stats_path;
+	}
+
+	//"--stream <file>" records what the world did every tick, "--play-stream <file>" watches such a recording
+	const char* stream_path = FindArgument (argc, argv, "--stream");
+	const char* play_stream_path = FindArgument (argc, argv, "--play-stream");
+	if (play_stream_path ? !app.play_stream (play_stream_path) : stream_path && !app.record_stream (stream_path))
+	{
+		return 1;
+	}
+
+	//"--world 200x150" makes the world bigger than the window, the camera scrolls over it
+	const char* world_size = FindArgument (argc, argv, "--world");
+	if (world_size && !app.world_size (world_size))
+	{
+		return 1;
+	}
 
 	InitWindow (window_width, window_height, window_title.data ());
 	InitAudioDevice ();
@@ -13,8 +114,9 @@ int main (int argc, char** argv)
 	SetExitKey (0);
 	HideCursor ();
 
-	sim::AppState app;
-	app.init (window_width, window_height);
+	TraceLog (LOG_INFO, "SIM: Seed %llu (pass --seed %llu to reproduce this run)", (unsigned long long)seed, (unsigned long long)seed);
+
+	app.init (window_width, window_height, seed, FindArgument (argc, argv, "--map"));
 
 	bool running = true;
 	while (running)
@@ -32,6 +134,8 @@ int main (int argc, char** argv)
 		EndDrawing ();
 	}
 
+	app.shut ();
+
 	CloseAudioDevice ();
 	CloseWindow ();
 
@@ -0,0 +1,19 @@
+// simthread.cpp
+
+#include "simthread.hpp"
+
+namespace sim
+{
+   void SimCommandQueue::post(const SimCommand& command)
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending.push_back(command);
+   }
+
+   void SimCommandQueue::take(std::vector<SimCommand>& commands)
+   {
+      commands.clear();
+      std::lock_guard<std::mutex> lock(mutex);
+      pending.swap(commands);
+   }
+}
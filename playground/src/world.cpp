@@ -1,6 +1,8 @@
 // world.cpp
 
 #include "world.hpp"
+#include <cstdlib>
+#include <cstring>
 
 namespace sim
 {
@@ -42,6 +44,74 @@ namespace sim
 		return m_ground[coord.y * m_world_size.x + coord.x].is_walkable ();
 	}
 
+	//Bresenham's line, one tile at a time
+	Point World::LastWalkableOnLine (const Point& start, const Point& target) const
+	{
+		const int dx = std::abs (target.x - start.x);
+		const int dy = -std::abs (target.y - start.y);
+		const int stepX = start.x < target.x ? 1 : -1;
+		const int stepY = start.y < target.y ? 1 : -1;
+		int error = dx + dy;
+
+		Point current = start;
+		Point reachable = start;
+		while (!(current == target))
+		{
+			const int doubled = 2 * error;
+			if (doubled >= dy)
+			{
+				error += dy;
+				current.x += stepX;
+			}
+			if (doubled <= dx)
+			{
+				error += dx;
+				current.y += stepY;
+			}
+			if (!is_walkable (current))
+			{
+				break;
+			}
+			reachable = current;
+		}
+		return reachable;
+	}
+
+	//Searches square rings of growing size around the coord, the straightest walkable tile of the first ring that has one wins
+	Point World::NearestWalkableTile (const Point& coord) const
+	{
+		if (is_walkable (coord))
+		{
+			return coord;
+		}
+
+		const int maxRadius = Math::max (m_world_size.x, m_world_size.y);
+		for (int radius = 1; radius <= maxRadius; radius++)
+		{
+			Point nearest = {-1, -1};
+			int nearestDistance = 0;
+			for (int y = coord.y - radius; y <= coord.y + radius; y++)
+			{
+				//Only the ring's edge, the inside was searched already
+				const int step = (y == coord.y - radius || y == coord.y + radius) ? 1 : 2 * radius;
+				for (int x = coord.x - radius; x <= coord.x + radius; x += step)
+				{
+					const int distance = (x - coord.x) * (x - coord.x) + (y - coord.y) * (y - coord.y);
+					if (is_walkable ({x, y}) && (nearest.x < 0 || distance < nearestDistance))
+					{
+						nearest = {x, y};
+						nearestDistance = distance;
+					}
+				}
+			}
+			if (nearest.x >= 0)
+			{
+				return nearest;
+			}
+		}
+		return {-1, -1};
+	}
+
 	bool World::has_grass_at (const Point& coord) const
 	{
 		if (!is_valid_coord (coord))
@@ -118,7 +188,9 @@ namespace sim
 
 	void World::EatGrass (const Vector2& position)
 	{
-		ReturnGrassAt (position_to_tile_coord (position)).DespawnGrass ();
+		const Point coord = position_to_tile_coord (position);
+		ReturnGrassAt (coord).DespawnGrass ();
+		m_heatmap.Record (Heatmap::GrassEaten, GetIndex (coord));
 	}
 
 	bool World::IsAnotherSheep (const Sheep& sheep1, const Sheep& sheep2) const
@@ -140,15 +212,17 @@ namespace sim
 		return m_grass[coord.y * m_world_size.x + coord.x];
 	}
 
+	//note: Called during the parallel sheep update, so it only looks at the frozen sheep views
 	int World::ReturnMatingSheep (const Sheep& sheep)
 	{
 		int sheepIndex = -1;
-		for (int i = 0; i < m_sheep.size (); i++)
+		for (int i = 0; i < (int)m_sheep_views.size (); i++)
 		{
-			const bool hasAMate = (m_sheep[i].isMatedWith == true) || (m_sheep[i].sheepToMate != -1);
-			const bool isCurrentlyReproducing = (m_sheep[i].currentState == m_sheep[i].Reproducing) && hasAMate;
-			const bool isAbleToReproduce = (m_sheep[i].currentState == m_sheep[i].Reproducing) && (m_sheep[i].isAlive == true);
-			if (isCurrentlyReproducing || !isAbleToReproduce || !IsAnotherSheep (m_sheep[i], sheep))
+			const Sheep::View& view = m_sheep_views[i];
+			const bool hasAMate = (view.isMatedWith == true) || (view.sheepToMate != -1);
+			const bool isCurrentlyReproducing = (view.state == Sheep::Reproducing) && hasAMate;
+			const bool isAbleToReproduce = (view.state == Sheep::Reproducing) && (view.isAlive == true);
+			if (isCurrentlyReproducing || !isAbleToReproduce || i == sheep.id)
 			{
 				continue;
 			}
@@ -166,7 +240,7 @@ namespace sim
 			return false;
 		}
 
-		if (!m_sheep[sheepIndex].isAlive || m_sheep[sheepIndex].currentState != m_sheep[sheepIndex].Reproducing)
+		if (!m_sheep_views[sheepIndex].isAlive || m_sheep_views[sheepIndex].state != Sheep::Reproducing)
 		{
 			return false;
 		}
@@ -176,7 +250,8 @@ namespace sim
 
 	bool World::isInRangeOfMating (int sheepIndex, const Vector2& position) const
 	{
-		const bool isInRangeOfMating = pow ((m_sheep[sheepIndex].m_position.x - position.x), 2.f) + pow ((m_sheep[sheepIndex].m_position.y - position.y), 2.f) <= pow ((2.f * m_sheep[sheepIndex].m_radius), 2.f) + 10.f;
+		const Sheep::View& mate = m_sheep_views[sheepIndex];
+		const bool isInRangeOfMating = pow ((mate.position.x - position.x), 2.f) + pow ((mate.position.y - position.y), 2.f) <= pow ((2.f * mate.radius), 2.f) + 10.f;
 		if (isInRangeOfMating)
 		{
 			return true;
@@ -184,37 +259,30 @@ namespace sim
 		return false;
 	}
 
-	int World::ReturnSheepToEat ()
+	int World::ReturnSheepToEat (const Wolf& wolf)
 	{
-		int sheepIndex = -1;
-		for (int i = 0; i < m_sheep.size (); i++)
+		//note: the sheep in hunting range are tracked by the perception events, sheep leaving the range stop being hunted there
+		for (int sheepIndex : wolf.sheepInRange)
 		{
-			//note: check if the sheep is a possible candidate to be eaten
-			const bool isSheepNearby = Vector2Distance (wolf.m_position, m_sheep[i].m_position) <= wolf.MAX_HUNTING_DISTANCE;
-			int distance = (int)Vector2Distance (wolf.m_position, m_sheep[i].m_position);
-
-			if (isSheepNearby && m_sheep[i].isAlive)
+			if (m_sheep[sheepIndex].isAlive)
 			{
-				sheepIndex = i;
-				break;
+				return sheepIndex;
 			}
-			m_sheep[i].set_sprite_source (m_sheep[i].sourceBeforeHunted);
-			m_sheep[i].isBeingHunted = false;
-
-			continue;
 		}
-		return sheepIndex;
+		return -1;
 	}
 
-	bool World::CanSheepBeEaten (int sheepIndex)
+	bool World::CanSheepBeEaten (int wolfIndex, int sheepIndex)
 	{
-		if (!isSheepValid (sheepIndex))
+		if (!isSheepValid (sheepIndex) || !isWolfValid (wolfIndex))
 		{
 			return false;
 		}
 
 		Sheep& sheep = m_sheep[sheepIndex];
+		const Wolf& wolf = m_wolves[wolfIndex];
 		sheep.isBeingHunted = true;
+		sheep.hunter = wolfIndex;
 
 		const bool isSheepInEatingRange = Vector2Distance (wolf.m_position, sheep.m_position) <= wolf.m_radius + sheep.m_radius;
 		if (sheep.isBeingHunted && isSheepInEatingRange)
@@ -224,10 +292,29 @@ namespace sim
 		return false;
 	}
 
-	void World::EatSheep (Sheep& sheep)
+	void World::EatSheep (int sheepIndex)
+	{
+		m_commands.Push (CommandBuffer::Command::EatSheep, sheepIndex);
+	}
+
+	bool World::isWolfValid (int wolfIndex) const
 	{
-		sheep.TakeDamage (10.0f);
-		sheep.isBeingHunted = false;
+		return wolfIndex >= 0 && wolfIndex < (int)m_wolves.size ();
+	}
+
+	bool World::isHerderValid (int herderIndex) const
+	{
+		return herderIndex >= 0 && herderIndex < (int)m_herders.size ();
+	}
+
+	int World::ClosestWolf (const Vector2& position, float range) const
+	{
+		return m_perception.m_wolf_grid.Closest (position, range);
+	}
+
+	int World::ClosestHerder (const Vector2& position, float range) const
+	{
+		return m_perception.m_herder_grid.Closest (position, range);
 	}
 
 	bool World::IsWolfNearby (const Point& coord) const
@@ -237,58 +324,140 @@ namespace sim
 			return true;
 		}
 
-		float distanceBetweenWolf = Vector2Distance (tile_coord_to_position(coord), wolf.m_position);
+		return ClosestWolf (tile_coord_to_position (coord), 2 * Sheep::RADIUS) != -1;
+	}
 
-		if (distanceBetweenWolf <= 2 * m_sheep[0].m_radius)
+	bool World::IsHerderNearby (const Point& coord) const
+	{
+		if (!is_valid_coord (coord))
 		{
 			return true;
 		}
 
-		return false;
+		return ClosestHerder (tile_coord_to_position (coord), 5 * Herder::RADIUS) != -1;
 	}
 
-	bool World::IsHerderNearby (const Point& coord) const
+	int World::HerderTooCloseTo (const Point& coord) const
 	{
+		//Outside the world every herder counts as too close, the first one gets attacked
 		if (!is_valid_coord (coord))
 		{
-			return true;
+			return m_herders.empty () ? -1 : 0;
 		}
 
-		float distanceBetweenHerder = Vector2Distance (tile_coord_to_position (coord), herder.m_position + herder.m_origin);
+		return ClosestHerder (tile_coord_to_position (coord), 3 * Herder::RADIUS);
+	}
 
-		if (distanceBetweenHerder <= 5 * herder.m_radius)
+	void World::AttackHerder (int herderIndex)
+	{
+		m_commands.Push (CommandBuffer::Command::AttackHerder, herderIndex);
+	}
+
+	int World::HerderAt (const Vector2& position) const
+	{
+		return ClosestHerder (position, 1.5f * Herder::RADIUS);
+	}
+
+	void World::SelectHerder (int herderIndex)
+	{
+		if (isHerderValid (herderIndex))
 		{
-			return true;
+			m_selected_herder = herderIndex;
 		}
-
-		return false;
 	}
 
-	bool World::IsHerderTooClose (const Point& coord) const
+	void World::MoveHerderTo (const Vector2& position)
 	{
-		if (!is_valid_coord (coord))
+		//A stunned herder can't be sent anywhere
+		if (isHerderValid (m_selected_herder) && !m_herders[m_selected_herder].isAttacked)
 		{
-			return true;
+			m_herders[m_selected_herder].targetCoord = position_to_tile_coord (position);
 		}
-		
-		float distanceBetweenHerder = Vector2Distance (tile_coord_to_position (coord), herder.m_position + herder.m_origin);
+	}
 
-		if (distanceBetweenHerder <= 3 * herder.m_radius)
+	bool World::set_tile_active (const Point& coord, bool active)
+	{
+		//Same result however often it is called on a tile, so the editor can paint while the button is held
+		const int index = GetIndex (coord);
+		Ground& ground = m_ground[index];
+		Grass& grass = m_grass[index];
+
+		bool changed = false;
+		if (ground.is_walkable () != active)
 		{
-			return true;
+			ground.set_walkable (active);
+			mark_ground_dirty (index);
+			changed = true;
 		}
-		return false;
+		if (active && !grass.is_alive ())
+		{
+			Random random = MakeRandom (Random::EditorEdit, index, m_tick);
+			grass.set_age (random.Range (0, 100) / 100.0f);
+			changed = true;
+		}
+		else if (!active && grass.is_alive ())
+		{
+			grass.set_age (0.0f);
+			changed = true;
+		}
+		return changed;
 	}
 
-	void World::AttackHerder ()
+	uint64_t World::Checksum () const
 	{
-		herder.isAttacked = true;
+		uint64_t hash = Random::Mix (m_seed ^ m_tick);
+		auto add = [&hash] (uint64_t value) { hash = Random::Mix (hash ^ value); };
+		auto addFloat = [&add] (float value) {
+			uint32_t bits = 0;
+			std::memcpy (&bits, &value, sizeof (bits));
+			add (bits);
+		};
+		auto addPosition = [&addFloat] (const Vector2& position) {
+			addFloat (position.x);
+			addFloat (position.y);
+		};
+
+		for (size_t i = 0; i < m_ground.size (); i++)
+		{
+			add ((uint64_t (m_ground[i].is_walkable ()) << 1) | uint64_t (m_ground[i].fertilised));
+			addFloat (m_grass[i].get_age ());
+		}
+		for (const Manure& tileManure : allManure)
+		{
+			//The duration of a despawned pile is stale and reset on the next spawn, so it is not part of the state
+			add (tileManure.manureExists);
+			if (tileManure.manureExists)
+			{
+				addFloat (tileManure.m_duration);
+			}
+		}
+		for (const Sheep& sheep : m_sheep)
+		{
+			addPosition (sheep.m_position);
+			addFloat (sheep.health);
+			add ((uint64_t (sheep.currentState) << 1) | uint64_t (sheep.isAlive));
+		}
+
+		for (const Wolf& wolf : m_wolves)
+		{
+			addPosition (wolf.m_position);
+			add (wolf.currentState);
+			add ((uint64_t)wolf.amountSheepEaten);
+		}
+		for (const Herder& herder : m_herders)
+		{
+			addPosition (herder.m_position);
+			add (uint64_t (herder.targetCoord.x) << 32 | uint32_t (herder.targetCoord.y));
+			add (herder.isAttacked);
+		}
+		add ((uint64_t)m_selected_herder);
+		return hash;
 	}
 
-	Point World::getRandomTile (Vector2 startPosition, float range)
+	Point World::getRandomTile (Vector2 startPosition, float range, Random& random)
 	{
-		int x = GetRandomValue (int (startPosition.x - range), int (startPosition.x + range));
-		int y = GetRandomValue (int (startPosition.y - range), int (startPosition.y + range));
+		int x = random.Range (int (startPosition.x - range), int (startPosition.x + range));
+		int y = random.Range (int (startPosition.y - range), int (startPosition.y + range));
 
 		Vector2 randomPosition = {(float)x,(float)y};
 
@@ -297,20 +466,33 @@ namespace sim
 		return position_to_tile_coord (randomPosition);
 	}
 
+	Random World::MakeRandom (Random::Stream stream, uint64_t entity, uint64_t subKey) const
+	{
+		return Random (m_seed, stream, entity, subKey);
+	}
+
 	void World::SpawnSheep (Vector2 position, bool randomise)
 	{
+		//The id of a sheep is its index, since sheep are never removed from the vector
+		const int id = (int)m_sheep.size ();
+
 		if (randomise)
 		{
-			const int x = GetRandomValue (int (m_world_bounds.x), int (m_world_bounds.x + m_world_bounds.width));
-			const int y = GetRandomValue (int (m_world_bounds.y), int (m_world_bounds.y + m_world_bounds.height));
+			Random random = MakeRandom (Random::WorldSpawn, id);
+			const int x = random.Range (int (m_world_bounds.x), int (m_world_bounds.x + m_world_bounds.width));
+			const int y = random.Range (int (m_world_bounds.y), int (m_world_bounds.y + m_world_bounds.height));
 
 			position = {(float)x, (float)y};
 		}
 
 		Sheep newSheep;
 		newSheep.Initiate (position);
+		newSheep.id = id;
+		newSheep.random = MakeRandom (Random::SheepBehaviour, id);
 		newSheep.world = this;
 		m_sheep.push_back (newSheep);
+
+		ScheduleAgent (WakeQueue::SheepAgent, id);
 	}
 
 	void World::SetSheepAsMate (Sheep& sheep)
@@ -342,6 +524,7 @@ namespace sim
 		m_grass[nearbyTiles.y * m_world_size.x + nearbyTiles.x].isFertilised = true;
 		m_grass[coord.y * m_world_size.x + coord.x].isEdible = false;
 		m_ground[nearbyTiles.y * m_world_size.x + nearbyTiles.x].FertiliseGround ();
+		mark_ground_dirty (GetIndex (nearbyTiles));
 
 	}
 
@@ -351,6 +534,7 @@ namespace sim
 		m_grass[nearbyTiles.y * m_world_size.x + nearbyTiles.x].isFertilised = false;
 		m_grass[coord.y * m_world_size.x + coord.x].isEdible = true;
 		m_ground[nearbyTiles.y * m_world_size.x + nearbyTiles.x].UnfertiliseGround ();
+		mark_ground_dirty (GetIndex (nearbyTiles));
 	}
 
 
@@ -408,12 +592,6 @@ namespace sim
 		return false;
 	}
 
-	//Get the index of a tile
-	inline int World::GetIndex (const Point& coord) const
-	{
-		return (int)(coord.y * m_world_size.x + coord.x);
-	}
-
 	//Reconstruct the path 
 	void World::GetPath (std::vector<Point>& path, const std::vector<Tile>& tiles, const Point& targetNode)
 	{
@@ -437,7 +615,36 @@ namespace sim
 		}
 	}
 
-	bool World::AStarPathFinding (const Point& startNode, const Point& targetNode, std::vector<Point>& path)
+	PathStats World::AStarPathFinding (const Point& startNode, const Point& targetNode, std::vector<Point>& path, const PathAgent& agent)
+	{
+		PROFILE_SCOPE (profiler::PathFinding);
+		const trace::Clock::time_point start = trace::Clock::now ();
+
+		PathStats stats;
+		SearchPath (startNode, targetNode, path, stats);
+		const trace::Clock::time_point end = trace::Clock::now ();
+		stats.microseconds = std::chrono::duration<double, std::micro> (end - start).count ();
+		m_path_telemetry.Record (agent, stats);
+
+		if (trace::IsEnabled ())
+		{
+			trace::Complete ("AStarPathFinding", "path", start, end, {
+				{"agent", agent.kind},
+				{"id", agent.id},
+				{"state", agent.state},
+				{"startX", startNode.x},
+				{"startY", startNode.y},
+				{"targetX", targetNode.x},
+				{"targetY", targetNode.y},
+				{"expanded", stats.expanded},
+				{"pushes", stats.frontierPushes},
+				{"found", stats.found},
+			});
+		}
+		return stats;
+	}
+
+	bool World::SearchPath (const Point& startNode, const Point& targetNode, std::vector<Point>& path, PathStats& stats)
 	{
 		//Ensuring the A* is not mixing with previously found paths
 		path.clear ();
@@ -451,6 +658,7 @@ namespace sim
 		//Early return if the target is reached already
 		if (startNode == targetNode)
 		{
+			stats.found = true;
 			return true; 
 		}
 
@@ -474,9 +682,13 @@ namespace sim
 		
 		//Add the start tile to the frontier
 		frontier.push (tiles[GetIndex (startNode)]);
+		stats.frontierPushes = 1;
 
 		bool hasFoundPath = false; 
 
+		//The expanded tiles go into the heatmap in one go once the search is over
+		std::vector<int> expanded;
+
 		//Only searching while the frontier is not empty
 		while (!frontier.empty()) {
 			
@@ -490,10 +702,12 @@ namespace sim
 			//Even though the same tile might be added to the frontier, the one with the lowest F-score (the most optimal one) will always be searched first
 			if (searchedTiles[GetIndex (currentTile.coord)] == true)
 			{
+				stats.stalePops++;
 				continue;
 			}
 			//Setting the current tile to be searched
 			searchedTiles[GetIndex (currentTile.coord)] = true;
+			expanded.push_back (GetIndex (currentTile.coord));
 
 			//Calculating all the surrounding tiles
 			Point neighbours[8];
@@ -502,18 +716,26 @@ namespace sim
 			//Going through each neighbouring tile and exploring them
 			for (auto nearbyTile : neighbours)
 			{
+				const size_t frontierSize = frontier.size ();
 				hasFoundPath = ExploreNeighbours (searchedTiles, tiles, frontier, nearbyTile, targetNode, currentTile.coord);
+				stats.frontierPushes += (int)(frontier.size () - frontierSize);
 
 				//If a path has been found to the destination, reconstruct it. 
 				if (hasFoundPath)
 				{
 					GetPath (path, tiles, targetNode);
+					m_heatmap.Record (Heatmap::PathExpansions, expanded);
+					stats.expanded = (int)expanded.size ();
+					stats.pathLength = (int)path.size ();
+					stats.found = true;
 					return true;
 				}
 
 			}
 		}
 
+		m_heatmap.Record (Heatmap::PathExpansions, expanded);
+		stats.expanded = (int)expanded.size ();
 		return false;
 	}
 
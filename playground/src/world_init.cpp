@@ -4,15 +4,24 @@
 
 namespace sim
 {
-	void World::init (int width, int height, Texture* texture, Texture* cursorTexture)
+	void World::init (int width, int height, Texture* texture, Texture* cursorTexture, uint64_t seed, Scheduler* scheduler, const WorldConfig& config, const MapFile* map)
 	{
+		m_config = config;
+		m_seed = seed;
+		m_tick = 0;
+		m_wake_queue.Clear ();
+		m_perception.Reset ();
+		m_scheduler = scheduler;
+
 		m_texture = texture;
 		m_cursorTexture = cursorTexture;
 
-		const int columns = (width / m_tile_size.x) - TILE_PADDING_X;
-		const int rows = (height / m_tile_size.y) - TILE_PADDING_Y;
-		const int start_x = (width - (columns * m_tile_size.x)) / 2;
-		const int start_y = (height - (rows * m_tile_size.y)) / 2;
+		// note: a map or the config can make the world bigger than the window, the camera then scrolls over it
+		const bool sized = config.worldColumns > 0 && config.worldRows > 0;
+		const int columns = map ? map->Columns () : sized ? config.worldColumns : (width / m_tile_size.x) - TILE_PADDING_X;
+		const int rows = map ? map->Rows () : sized ? config.worldRows : (height / m_tile_size.y) - TILE_PADDING_Y;
+		const int start_x = Math::max ((width - (columns * m_tile_size.x)) / 2, 0);
+		const int start_y = Math::max ((height - (rows * m_tile_size.y)) / 2, 0);
 
 		// note: world settings
 		m_world_size = {columns, rows};
@@ -23,6 +32,7 @@ namespace sim
 		   .width = float (columns * m_tile_size.x),
 		   .height = float (rows * m_tile_size.y)
 		};
+		m_view_bounds = m_world_bounds;
 
 		{ // note: initialize ground layer
 			m_ground.resize (columns * rows);
@@ -37,8 +47,20 @@ namespace sim
 
 				const Point tile_coord{x, y};
 				ground.set_tile_coord (tile_coord);
-				ground.set_walkable (true);
+				ground.set_walkable (map ? map->IsWalkable (GetIndex (tile_coord)) : true);
+				ground.fertilised = false;
+
+				if (map && map->IsFertilised (GetIndex (tile_coord)))
+				{
+					ground.FertiliseGround ();
+				}
 			}
+
+			m_dirty_ground.clear ();
+			m_ground_dirty_flags.assign (m_ground.size (), 0);
+			invalidate_ground_layer ();
+			m_heatmap.Init ((int)m_ground.size ());
+			m_path_telemetry.Clear ();
 		}
 
 		{ // note: initialize grass layer
@@ -54,10 +76,18 @@ namespace sim
 				const Point tile_coord{x, y};
 				grass.set_tile_coord (tile_coord);
 
-				// note: 50% chance to spawn
-				if (GetRandomValue (0, 100) > 50)
+				// note: grass from the map if it has any, otherwise 50% chance to spawn
+				if (map && map->HasLayer (MapFile::GrassLayer))
 				{
-					const float age = (float)GetRandomValue (1, 100) / 100.0f;
+					grass.set_age (map->GrassAge (GetIndex (tile_coord)));
+					grass.world = this;
+					continue;
+				}
+
+				Random random = MakeRandom (Random::WorldInit, GetIndex (tile_coord));
+				if (random.Range (0, 100) > 50)
+				{
+					const float age = (float)random.Range (1, 100) / 100.0f;
 					grass.set_age (age);
 				}
 
@@ -66,15 +96,37 @@ namespace sim
 		}
 
 		{ // note: initialize sheep
-			for (int i = 0; i < START_AMOUNT_SHEEP; i++)
+			for (int i = 0; i < m_config.startAmountSheep; i++)
 			{
 				SpawnSheep ({0,0}, true);
 			}
 		}
 
-		{ // note: initialize wolf
-			wolf.Spawn ();
-			wolf.world = this;
+		{ // note: initialize wolves, a pack at a time in front of its den. The first den is where the single wolf's den used to be, the others are random
+			const int wolfCount = Math::max (m_config.startAmountWolves, 0);
+			const int packSize = Math::max (m_config.wolfPackSize, 1);
+			m_wolves.assign (wolfCount, Wolf{});
+
+			Vector2 den = FIRST_WOLFS_DEN;
+			for (int i = 0; i < wolfCount; i++)
+			{
+				Wolf& wolf = m_wolves[i];
+				wolf.world = this;
+				wolf.id = i;
+				wolf.pack = i / packSize;
+
+				const int member = i % packSize;
+				if (member == 0 && wolf.pack > 0)
+				{
+					Random random = MakeRandom (Random::WolfDen, wolf.pack);
+					const Point tile = {random.Range (1, Math::max (columns - 3, 1)), random.Range (1, Math::max (rows - 3, 1))};
+					den = tile_coord_to_position (tile);
+				}
+
+				wolf.Spawn (den, den + Vector2{32.f + 24.f * member, 50.f});
+				wolf.random = MakeRandom (Random::WolfBehaviour, i);
+				ScheduleAgent (WakeQueue::WolfAgent, i);
+			}
 		}
 
 		{ // note: initialise manure
@@ -92,11 +144,23 @@ namespace sim
 			}
 		}
 
-		{ // note: initialize herder
-			herder.world = this;
-			herder.Init ();
+		{ // note: initialize herders, the player starts out moving the first one
+			const int herderCount = Math::max (m_config.startAmountHerders, 0);
+			m_herders.assign (herderCount, Herder{});
+			for (int i = 0; i < herderCount; i++)
+			{
+				const Point tile = FIRST_HERDER_TILE + Point{3 * (i % HERDERS_PER_ROW), 3 * (i / HERDERS_PER_ROW)};
+
+				Herder& herder = m_herders[i];
+				herder.world = this;
+				herder.id = i;
+				herder.Init ({Math::min (tile.x, columns - 1), Math::min (tile.y, rows - 1)});
+			}
+			m_selected_herder = herderCount > 0 ? 0 : -1;
 		}
 	}
 	void World::shut ()
-	{}
+	{
+		unload_ground_layer ();
+	}
 } // !sim
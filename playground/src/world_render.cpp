@@ -1,85 +1,305 @@
 // world_render.cpp
 
 #include "world.hpp"
+#include <algorithm>
 
 namespace sim
 {
-	void World::render () const
+	void World::render (const Rectangle& view) const
 	{
 		assert (m_texture);
 
-		const Vector2 ZERO{};
 		const Vector2 tile_size = m_tile_size.to_vec2 ();
+		const Rectangle visible{view.x - RENDER_MARGIN, view.y - RENDER_MARGIN, view.width + 2.f * RENDER_MARGIN, view.height + 2.f * RENDER_MARGIN};
 
-		{ // note: render ground
-			for (const Ground& ground : m_ground)
+		Point first, last;
+		visible_tiles (visible, first, last);
+
+		{ // note: render ground, one quad per cached chunk in view
+			PROFILE_SCOPE (profiler::RenderGround);
+			for (int i = 0; i < (int)m_ground_chunks.size (); i++)
 			{
-				if (!ground.is_walkable ())
+				const Point chunk{i % m_ground_chunk_count.x, i / m_ground_chunk_count.x};
+				const Texture2D& layer = m_ground_chunks[i].texture;
+				const Vector2 position = (m_world_offset + chunk * Point{GROUND_CHUNK_TILES, GROUND_CHUNK_TILES} * m_tile_size).to_vec2 ();
+				const Rectangle destination{position.x, position.y, (float)layer.width, (float)layer.height};
+				if (!CheckCollisionRecs (destination, view))
 				{
 					continue;
 				}
 
-				const Vector2 position = (m_world_offset + ground.m_tile_coord * m_tile_size).to_vec2 ();
-				const Rectangle destination{position.x, position.y, tile_size.x, tile_size.y};
-				DrawTexturePro (*m_texture, ground.source, destination, ZERO, 0.0f, WHITE);
+				//Render textures are stored upside down
+				m_sprite_batch.Begin (layer);
+				m_sprite_batch.Add ({0.0f, 0.0f, (float)layer.width, -(float)layer.height}, destination);
+				m_sprite_batch.End ();
 			}
 		}
 
-		{ // note: render grass
+		// note: everything else comes from the same atlas, so it all goes out as one batch
+		PROFILE_SCOPE (profiler::RenderSprites);
+		m_sprite_batch.Begin (*m_texture);
 
-			for (const Grass& tile : m_grass)
+		{ // note: render grass, only the rows and columns in view
+			for (int y = first.y; y < last.y; y++)
 			{
-				if (!tile.is_alive ())
+				for (int x = first.x; x < last.x; x++)
+				{
+					const Grass& tile = m_grass[GetIndex ({x, y})];
+					if (!tile.is_alive ())
+					{
+						continue;
+					}
+
+					const int index = int (tile.m_age * _countof (tile.sources));
+					const Vector2 position = (m_world_offset + tile.m_tile_coord * m_tile_size).to_vec2 ();
+					const Rectangle source = tile.sources[index];
+					const Rectangle destination{position.x, position.y, tile_size.x, tile_size.y};
+					m_sprite_batch.Add (source, destination);
+				}
+			}
+		}
+
+		// note: render manure, a pile is drawn within its tile
+		for (int y = first.y; y < last.y; y++)
+		{
+			for (int x = first.x; x < last.x; x++)
+			{
+				const Manure& manures = allManure[GetIndex ({x, y})];
+				if (!manures.manureExists)
 				{
 					continue;
 				}
+				manures.render (m_sprite_batch);
+			}
+		}
 
-				const int index = int (tile.m_age * _countof (tile.sources));
-				const Vector2 position = (m_world_offset + tile.m_tile_coord * m_tile_size).to_vec2 ();
-				const Rectangle source = tile.sources[index];
-				const Rectangle destination{position.x, position.y, tile_size.x, tile_size.y};
-				DrawTexturePro (*m_texture, source, destination, ZERO, 0.0f, WHITE);
+		// note: render wolfs dens, once per pack
+		for (int i = 0; i < (int)m_wolves.size (); i++)
+		{
+			if ((i == 0 || m_wolves[i].pack != m_wolves[i - 1].pack) && CheckCollisionPointRec (m_wolves[i].wolfsDenPosition, visible))
+			{
+				m_wolves[i].RenderWolfsDen (m_sprite_batch);
 			}
 		}
 
-		// note: render manure
-		for (const auto& manures : allManure)
+		// note: render sheep, found through the render grid
+		query_visible_sheep (view, m_visible_sheep);
+		for (int index : m_visible_sheep)
+		{
+			m_sheep[index].render (m_sprite_batch);
+		}
+
+		// note: render wolves
+		for (const Wolf& wolf : m_wolves)
 		{
-			if (!manures.manureExists)
+			if (CheckCollisionPointRec (wolf.m_position, visible))
 			{
-				continue;
+				wolf.render (m_sprite_batch);
 			}
-			manures.render (*m_texture);
 		}
 
-		// note: render wolfs den
-		wolf.RenderWolfsDen (*m_texture);
+		// note: render herders, with a ring around the one the player moves when there is a choice. A herder's target frame is drawn with it, so it is not culled
+		for (const Herder& herder : m_herders)
+		{
+			herder.Render (m_sprite_batch);
+		}
+		m_sprite_batch.End ();
+
+		if (m_herders.size () > 1 && isHerderValid (m_selected_herder))
+		{
+			const Herder& selected = m_herders[m_selected_herder];
+			DrawCircleLinesV (selected.m_position + selected.m_origin / 2.f, selected.m_radius, YELLOW);
+		}
+	}
+
+	void World::render_cursor () const
+	{
+		Rectangle source = CURSOR_NORMAL;
+		//If the selected herder is attacked, render the blocked cursor
+		if (isHerderValid (m_selected_herder) && m_herders[m_selected_herder].isAttacked)
+		{
+			source = CURSOR_BLOCKED;
+		}
+		m_sprite_batch.Begin (*m_cursorTexture);
+		m_sprite_batch.Add (source, {GetMousePosition ().x, GetMousePosition ().y, 32.f, 32.f});
+		m_sprite_batch.End ();
+	}
 
-		// note: render sheep
-		for (const auto& sheep : m_sheep)
+	void World::prepare_render ()
+	{
+		redraw_ground_layer ();
+
+		//Sheep move every tick and are born during it, so the grid is built from scratch. Once per frame however many ticks ran
+		m_render_grid.Begin (m_world_bounds, Perception::CELL_SIZE);
+		for (int i = 0; i < (int)m_sheep.size (); i++)
 		{
-			if (!sheep.isAlive)
+			if (m_sheep[i].isAlive)
 			{
-				continue;
+				m_render_grid.Add (i, m_sheep[i].m_position);
 			}
-			sheep.render (*m_texture);
 		}
+		m_render_grid.Finish ();
+	}
 
-		// note: render wolf
-		wolf.render (*m_texture);
+	void World::visible_tiles (const Rectangle& view, Point& first, Point& last) const
+	{
+		const float left = (view.x - (float)m_world_offset.x) / (float)m_tile_size.x;
+		const float top = (view.y - (float)m_world_offset.y) / (float)m_tile_size.y;
+		const float right = (view.x + view.width - (float)m_world_offset.x) / (float)m_tile_size.x;
+		const float bottom = (view.y + view.height - (float)m_world_offset.y) / (float)m_tile_size.y;
+
+		first = {Math::clamp ((int)std::floor (left), 0, m_world_size.x), Math::clamp ((int)std::floor (top), 0, m_world_size.y)};
+		last = {Math::clamp ((int)std::ceil (right), 0, m_world_size.x), Math::clamp ((int)std::ceil (bottom), 0, m_world_size.y)};
+	}
 
-		// note: render herder
-		herder.Render (*m_texture);
+	void World::query_visible_sheep (const Rectangle& view, std::vector<int>& result) const
+	{
+		const Rectangle visible{view.x - RENDER_MARGIN, view.y - RENDER_MARGIN, view.width + 2.f * RENDER_MARGIN, view.height + 2.f * RENDER_MARGIN};
+		result.clear ();
+		m_render_grid.QueryRect (visible, result);
+	}
 
-		// note: render cursor
+	void World::redraw_ground_layer ()
+	{
+		const Point chunk_count{(m_world_size.x + GROUND_CHUNK_TILES - 1) / GROUND_CHUNK_TILES, (m_world_size.y + GROUND_CHUNK_TILES - 1) / GROUND_CHUNK_TILES};
+		if (!(chunk_count == m_ground_chunk_count))
 		{
-			Rectangle source = CURSOR_NORMAL;
-			//If the herder is attacked, render the blocked cursor
-			if (herder.isAttacked)
+			unload_ground_layer ();
+			m_ground_chunk_count = chunk_count;
+			for (int y = 0; y < chunk_count.y; y++)
 			{
-				source = CURSOR_BLOCKED;
+				for (int x = 0; x < chunk_count.x; x++)
+				{
+					const Point size = ground_chunk_tiles ({x, y}) * m_tile_size;
+					m_ground_chunks.push_back (LoadRenderTexture (size.x, size.y));
+				}
 			}
-			DrawTexturePro (*m_cursorTexture, source, {GetMousePosition ().x, GetMousePosition ().y, 32.f, 32.f}, {0.f,0.f}, 0.f, WHITE);
+			invalidate_ground_layer ();
 		}
+
+		if (m_ground_layer_stale)
+		{
+			for (int i = 0; i < (int)m_ground_chunks.size (); i++)
+			{
+				const Point chunk{i % chunk_count.x, i / chunk_count.x};
+				const Point first = chunk * Point{GROUND_CHUNK_TILES, GROUND_CHUNK_TILES};
+				const Point tiles = ground_chunk_tiles (chunk);
+
+				BeginTextureMode (m_ground_chunks[i]);
+				ClearBackground (BLANK);
+				for (int y = first.y; y < first.y + tiles.y; y++)
+				{
+					for (int x = first.x; x < first.x + tiles.x; x++)
+					{
+						draw_ground_tile (GetIndex ({x, y}), chunk);
+					}
+				}
+				EndTextureMode ();
+			}
+			m_ground_layer_stale = false;
+			return;
+		}
+
+		if (m_dirty_ground.empty ())
+		{
+			return;
+		}
+
+		//Sorted by chunk, so every chunk is bound once
+		auto chunk_of = [this] (int index) {
+			const Point coord{index % m_world_size.x, index / m_world_size.x};
+			return Point{coord.x / GROUND_CHUNK_TILES, coord.y / GROUND_CHUNK_TILES};
+		};
+		auto chunk_index = [this, &chunk_of] (int index) {
+			const Point chunk = chunk_of (index);
+			return chunk.y * m_ground_chunk_count.x + chunk.x;
+		};
+		std::sort (m_dirty_ground.begin (), m_dirty_ground.end (), [&chunk_index] (int lhs, int rhs) {
+			return chunk_index (lhs) < chunk_index (rhs);
+		});
+
+		int bound = -1;
+		for (int index : m_dirty_ground)
+		{
+			if (chunk_index (index) != bound)
+			{
+				if (bound >= 0)
+				{
+					EndTextureMode ();
+				}
+				bound = chunk_index (index);
+				BeginTextureMode (m_ground_chunks[bound]);
+			}
+
+			//A tile that became a wall has to end up transparent, so the old sprite is cleared rather than drawn over
+			const Point chunk = chunk_of (index);
+			const Point local = m_ground[index].m_tile_coord - chunk * Point{GROUND_CHUNK_TILES, GROUND_CHUNK_TILES};
+			BeginScissorMode (local.x * m_tile_size.x, local.y * m_tile_size.y, m_tile_size.x, m_tile_size.y);
+			ClearBackground (BLANK);
+			EndScissorMode ();
+
+			draw_ground_tile (index, chunk);
+			m_ground_dirty_flags[index] = 0;
+		}
+		EndTextureMode ();
+		m_dirty_ground.clear ();
+	}
+
+	void World::mark_ground_dirty (int index)
+	{
+		if (m_ground_layer_stale || m_ground_dirty_flags[index])
+		{
+			return;
+		}
+
+		//Past a quarter of the map, one full redraw is cheaper than going tile by tile
+		if (m_dirty_ground.size () >= m_ground.size () / 4)
+		{
+			invalidate_ground_layer ();
+			return;
+		}
+
+		m_ground_dirty_flags[index] = 1;
+		m_dirty_ground.push_back (index);
+	}
+
+	void World::invalidate_ground_layer ()
+	{
+		m_ground_layer_stale = true;
+		for (int index : m_dirty_ground)
+		{
+			m_ground_dirty_flags[index] = 0;
+		}
+		m_dirty_ground.clear ();
+	}
+
+	void World::unload_ground_layer ()
+	{
+		for (const RenderTexture2D& chunk : m_ground_chunks)
+		{
+			UnloadRenderTexture (chunk);
+		}
+		m_ground_chunks.clear ();
+		m_ground_chunk_count = {};
+	}
+
+	Point World::ground_chunk_tiles (const Point& chunk) const
+	{
+		//The last chunk of a row or column only covers what is left of the map
+		const Point first = chunk * Point{GROUND_CHUNK_TILES, GROUND_CHUNK_TILES};
+		return {Math::min (GROUND_CHUNK_TILES, m_world_size.x - first.x), Math::min (GROUND_CHUNK_TILES, m_world_size.y - first.y)};
+	}
+
+	void World::draw_ground_tile (int index, const Point& chunk) const
+	{
+		const Ground& ground = m_ground[index];
+		if (!ground.is_walkable ())
+		{
+			return;
+		}
+
+		const Vector2 position = ((ground.m_tile_coord - chunk * Point{GROUND_CHUNK_TILES, GROUND_CHUNK_TILES}) * m_tile_size).to_vec2 ();
+		const Rectangle destination{position.x, position.y, (float)m_tile_size.x, (float)m_tile_size.y};
+		DrawTexturePro (*m_texture, ground.source, destination, {}, 0.0f, WHITE);
 	}
 }
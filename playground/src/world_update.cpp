@@ -29,45 +29,385 @@ namespace sim
 		}
 	}
 
-	bool World::update (float dt)
+	int World::RowBandCount () const
+	{
+		const int threads = m_scheduler ? m_scheduler->WorkerCount () : 1;
+		return Math::clamp (threads * BANDS_PER_THREAD, 1, Math::max (m_world_size.y, 1));
+	}
+
+	int World::SheepJobCount () const
+	{
+		return ((int)m_sheep.size () + SHEEP_PER_JOB - 1) / SHEEP_PER_JOB;
+	}
+
+	void World::RunTasks ()
 	{
-		if (IsKeyReleased (KEY_ESCAPE))
+		if (m_scheduler)
+		{
+			m_scheduler->Run (m_task_graph);
+		}
+		else
 		{
-			m_running = false;
+			m_task_graph.RunSerial ();
 		}
+	}
 
-		// todo: update grass
-		for (auto& grass : m_grass)
+	void World::TakePassCosts (double (&seconds)[PASS_COUNT])
+	{
+		for (int pass = 0; pass < PASS_COUNT; pass++)
 		{
-			grass.Update (dt);
+			seconds[pass] = (double)m_pass_microseconds[pass].exchange (0) / 1e6;
 		}
+	}
 
+	void World::UpdateGrassBand (float dt, int band)
+	{
+		const int bands = (int)m_grass_spread_requests.size ();
+		std::vector<Point>& requests = m_grass_spread_requests[band];
+		requests.clear ();
 
-		// note: update sheep
-		for (auto& sheep : m_sheep)
+		const int first = GetIndex ({0, band * m_world_size.y / bands});
+		const int last = GetIndex ({0, (band + 1) * m_world_size.y / bands});
+		for (int i = first; i < last; i++)
 		{
-			sheep.update (dt);
-			contain_within_bounds (sheep, m_world_bounds);
+			m_grass[i].Update (dt, requests);
 		}
+	}
 
-		// update manure
-		for (auto& manures : allManure)
+	void World::MergeGrassSpreading ()
+	{
+		// note: spreading is applied after the pass, in band order
+		for (const auto& requests : m_grass_spread_requests)
+		{
+			for (const Point& coord : requests)
+			{
+				if (!has_grass_at (coord))
+				{
+					ReturnGrassAt (coord).SpawnGrass ();
+				}
+			}
+		}
+	}
+
+	void World::UpdateManureBand (float dt, int band)
+	{
+		const int bands = (int)m_fertilise_requests.size ();
+		std::vector<Manure::FertiliseRequest>& requests = m_fertilise_requests[band];
+		requests.clear ();
+
+		const int first = GetIndex ({0, band * m_world_size.y / bands});
+		const int last = GetIndex ({0, (band + 1) * m_world_size.y / bands});
+		for (int i = first; i < last; i++)
 		{
-			manures.update (dt);
+			allManure[i].update (dt, requests);
+		}
+	}
+
+	void World::MergeFertilising ()
+	{
+		// note: (de)fertilising is applied after the pass, in band order
+		for (const auto& requests : m_fertilise_requests)
+		{
+			for (const Manure::FertiliseRequest& request : requests)
+			{
+				if (!request.fertilise)
+				{
+					Defertilise (request.coord, request.nearbyTile);
+				}
+				else if (!IsGroundFertilised (request.nearbyTile))
+				{
+					Fertilise (request.coord, request.nearbyTile);
+				}
+			}
+		}
+	}
+
+	int World::SecondsToTicks (float seconds)
+	{
+		return Math::max ((int)std::lround (seconds * TICKS_PER_SECOND), 1);
+	}
+
+	void World::ScheduleAgent (WakeQueue::AgentType agent, int index)
+	{
+		const float senseInterval = agent == WakeQueue::SheepAgent ? m_config.sheepSenseInterval : m_config.wolfSenseInterval;
+		const float thinkInterval = agent == WakeQueue::SheepAgent ? m_config.sheepThinkInterval : m_config.wolfThinkInterval;
+
+		// note: the first wake-up is a full interval away (like the timers used to be), on whichever tick of that interval is the quietest
+		const int senseTicks = SecondsToTicks (senseInterval);
+		const int thinkTicks = SecondsToTicks (thinkInterval);
+		m_wake_queue.ScheduleStaggered (m_tick + senseTicks, senseTicks, {0, agent, index, WakeQueue::Sense});
+		m_wake_queue.ScheduleStaggered (m_tick + thinkTicks, thinkTicks, {0, agent, index, WakeQueue::Think});
+	}
+
+	void World::WakeAgents ()
+	{
+		m_due_wake_ups.clear ();
+		m_wake_queue.PopDue (m_tick, m_due_wake_ups);
+
+		for (WakeQueue::WakeUp wakeUp : m_due_wake_ups)
+		{
+			const bool isSense = wakeUp.phase == WakeQueue::Sense;
+			float interval = 0.f;
+
+			if (wakeUp.agent == WakeQueue::SheepAgent)
+			{
+				Sheep& sheep = m_sheep[wakeUp.index];
+
+				//Dead sheep are not rescheduled
+				if (!sheep.isAlive)
+				{
+					continue;
+				}
+				(isSense ? sheep.senseDue : sheep.thinkDue) = true;
+				interval = isSense ? sheep.SenseInterval () : m_config.sheepThinkInterval;
+			}
+			else
+			{
+				Wolf& wolf = m_wolves[wakeUp.index];
+				(isSense ? wolf.senseDue : wolf.thinkDue) = true;
+				interval = isSense ? m_config.wolfSenseInterval : m_config.wolfThinkInterval;
+			}
+
+			wakeUp.tick = m_tick + SecondsToTicks (interval);
+			m_wake_queue.Schedule (wakeUp);
+		}
+	}
+
+	void World::Perceive ()
+	{
+		m_perception.Update (*this);
+		m_perception.Deliver (*this);
+	}
+
+	void World::set_view (const Rectangle& view)
+	{
+		m_view_bounds = view;
+	}
+
+	void World::UpdateDetailLevels ()
+	{
+		const Rectangle view = {
+			m_view_bounds.x - DETAIL_VIEW_MARGIN,
+			m_view_bounds.y - DETAIL_VIEW_MARGIN,
+			m_view_bounds.width + 2.f * DETAIL_VIEW_MARGIN,
+			m_view_bounds.height + 2.f * DETAIL_VIEW_MARGIN
 		};
 
+		for (int& count : m_detail_counts)
+		{
+			count = 0;
+		}
+
+		for (Sheep& sheep : m_sheep)
+		{
+			if (!sheep.isAlive)
+			{
+				continue;
+			}
+
+			sheep.SetDetail (CheckCollisionPointRec (sheep.m_position, view) ? Sheep::FullDetail : Sheep::CoarseDetail);
+			m_detail_counts[sheep.detail]++;
+		}
+	}
+
+	void World::TakeSheepViews ()
+	{
+		m_sheep_views.resize (m_sheep.size ());
+		for (int i = 0; i < (int)m_sheep.size (); i++)
+		{
+			m_sheep_views[i] = m_sheep[i].GetView ();
+		}
+	}
 
-		// update wolf
+	void World::UpdateSheepJob (float dt, int job)
+	{
+		const int last = Math::min ((job + 1) * SHEEP_PER_JOB, (int)m_sheep.size ());
+		for (int i = job * SHEEP_PER_JOB; i < last; i++)
 		{
-			wolf.update (dt);
-			contain_within_bounds (wolf, m_world_bounds);
+			m_sheep[i].update (dt);
+			contain_within_bounds (m_sheep[i], m_world_bounds);
 		}
+	}
+
+	void World::CommitSheepIntents ()
+	{
+		m_mate_claims.assign (m_sheep.size (), -1);
+		m_presence_tiles.clear ();
 
-		// update herder
+		for (int i = 0; i < (int)m_sheep.size (); i++)
 		{
-			herder.Update (dt);
+			for (const Sheep::Intent& intent : m_sheep[i].intents)
+			{
+				switch (intent.type)
+				{
+					case Sheep::Intent::EatGrassAt:
+					{
+						//The first sheep to commit gets the grass, the others keep being hungry
+						if (CanGrassBeEaten (intent.position))
+						{
+							EatGrass (intent.position);
+							m_sheep[i].EatGrass ();
+						}
+						break;
+					}
+					case Sheep::Intent::DefecateAt:
+					{
+						Defecate (intent.position);
+						break;
+					}
+					case Sheep::Intent::PairWith:
+					{
+						//A mate already claimed by another sheep, or a sheep that got claimed as a mate itself, can't pair up
+						const int claim = m_mate_claims[intent.sheep];
+						if ((claim != -1 && claim != i) || m_mate_claims[i] != -1 || m_sheep[i].isMatedWith)
+						{
+							m_sheep[i].CancelMating ();
+							break;
+						}
+						m_mate_claims[intent.sheep] = i;
+						m_commands.Push (CommandBuffer::Command::PairSheep, intent.sheep);
+						break;
+					}
+					case Sheep::Intent::Unpair:
+					{
+						m_commands.Push (CommandBuffer::Command::UnpairSheep, intent.sheep);
+						break;
+					}
+					case Sheep::Intent::SpawnLamb:
+					{
+						m_commands.Push (CommandBuffer::Command::SpawnSheep, -1, intent.position);
+						break;
+					}
+					case Sheep::Intent::Die:
+					{
+						m_commands.Push (CommandBuffer::Command::KillSheep, i);
+						break;
+					}
+				}
+			}
+			m_sheep[i].intents.clear ();
+
+			//Counted here rather than while the sheep move, the parallel jobs would all contend for the heatmap
+			if (m_sheep[i].isAlive)
+			{
+				m_presence_tiles.push_back (GetIndex (position_to_tile_coord (m_sheep[i].m_position)));
+			}
 		}
+		m_heatmap.Record (Heatmap::SheepPresence, m_presence_tiles);
+	}
+
+	void World::PlaybackCommands ()
+	{
+		// note: this is the sync point of the tick, nothing else is iterating the agents anymore
+		m_sheep.reserve (m_sheep.size () + m_commands.Count (CommandBuffer::Command::SpawnSheep));
+
+		for (const CommandBuffer::Command& command : m_commands.commands)
+		{
+			switch (command.type)
+			{
+				case CommandBuffer::Command::SpawnSheep:
+				{
+					SpawnSheep (command.position);
+					break;
+				}
+				case CommandBuffer::Command::KillSheep:
+				{
+					Sheep& sheep = m_sheep[command.target];
+					sheep.KillSheep ();
+
+					//Making sure if the sheep has a mate, that the other sheep does not get stuck in mating
+					if (isSheepValid (sheep.sheepToMate))
+					{
+						ResetSheepMate (m_sheep[sheep.sheepToMate]);
+					}
+					break;
+				}
+				case CommandBuffer::Command::PairSheep:
+				{
+					SetSheepAsMate (m_sheep[command.target]);
+					break;
+				}
+				case CommandBuffer::Command::UnpairSheep:
+				{
+					ResetSheepMate (m_sheep[command.target]);
+					break;
+				}
+				case CommandBuffer::Command::EatSheep:
+				{
+					Sheep& sheep = m_sheep[command.target];
+					const bool wasHealthy = sheep.health > 0.0f;
+					sheep.TakeDamage (10.0f);
+					sheep.isBeingHunted = false;
+					if (wasHealthy && sheep.health <= 0.0f)
+					{
+						m_heatmap.Record (Heatmap::WolfKills, GetIndex (position_to_tile_coord (sheep.m_position)));
+					}
+					break;
+				}
+				case CommandBuffer::Command::AttackHerder:
+				{
+					if (isHerderValid (command.target))
+					{
+						m_herders[command.target].isAttacked = true;
+					}
+					break;
+				}
+			}
+		}
+		m_commands.Clear ();
+	}
+
+	bool World::update (float dt)
+	{
+		PROFILE_SCOPE (profiler::Tick);
+
+		// note: the tick is one task graph: grass -> sheep -> manure -> wolves, with each layer split into parallel jobs
+		m_task_graph.Clear ();
+
+		const int bands = RowBandCount ();
+		m_grass_spread_requests.resize (bands);
+		m_fertilise_requests.resize (bands);
+
+		// note: update grass
+		const int grassBands = m_task_graph.AddParallelFor (bands, Timed (GrassPass, [this, dt] (int band) { UpdateGrassBand (dt, band); }));
+		const int grass = m_task_graph.Add (Timed (GrassPass, [this] { MergeGrassSpreading (); }), {grassBands});
+
+		// note: perceive the proximity changes of this tick, the events can wake agents up early
+		const int perceive = m_task_graph.Add (Timed (PerceptionPass, [this] { Perceive (); }), {grass});
+
+		// note: sheep outside the camera view sense less often and skip path finding
+		const int detail = m_task_graph.Add (Timed (PerceptionPass, [this] { UpdateDetailLevels (); }), {perceive});
+
+		// note: wake up the agents whose sense/think is due this tick
+		const int wake = m_task_graph.Add (Timed (PerceptionPass, [this] { WakeAgents (); }), {detail});
+
+		// note: update sheep, sense/think/act run in parallel over a frozen view of the sheep and the cross-sheep changes are committed afterwards
+		const int views = m_task_graph.Add (Timed (SheepPass, [this] { TakeSheepViews (); }));
+		const int sheepJobs = m_task_graph.AddParallelFor (SheepJobCount (), Timed (SheepPass, [this, dt] (int job) { UpdateSheepJob (dt, job); }), {views, grass, wake});
+		const int sheep = m_task_graph.Add (Timed (SheepPass, [this] { CommitSheepIntents (); }), {sheepJobs});
+
+		// update manure
+		const int manureBands = m_task_graph.AddParallelFor (bands, Timed (ManurePass, [this, dt] (int band) { UpdateManureBand (dt, band); }), {sheep});
+		const int manure = m_task_graph.Add (Timed (ManurePass, [this] { MergeFertilising (); }), {manureBands});
+
+		// update herders, their path requests only read the ground so they run next to the layers and each other (once perception has read their positions)
+		const int herderUpdate = m_task_graph.AddParallelFor ((int)m_herders.size (), Timed (HerderPass, [this, dt] (int index) { m_herders[index].Update (dt); }), {perceive});
+
+		// update wolves, in order: a wolf marks the sheep it hunts and queues attacks, which the next wolf may look at
+		const int wolfUpdate = m_task_graph.Add (Timed (WolfPass, [this, dt] {
+			for (Wolf& wolf : m_wolves)
+			{
+				wolf.update (dt);
+				contain_within_bounds (wolf, m_world_bounds);
+			}
+		}), {manure, herderUpdate});
+
+		// note: sync point, the queued spawns/deaths/pairings are applied once every agent is done
+		m_task_graph.Add (Timed (CommandPass, [this] { PlaybackCommands (); }), {wolfUpdate});
+
+		RunTasks ();
 
+		m_tick++;
 
 		return m_running;
 	}